@@ -10,6 +10,7 @@
 #include <QThread>
 #include <QMetaObject>
 #include <algorithm>
+#include <unordered_set>
 #include "version.h"
 
 extern QuickAccessUtility *qau;
@@ -24,11 +25,6 @@ const std::map<SearchType, std::string> SearchTypeNames{
 	{SearchType::Url, "URL"},
 	{SearchType::Filters, "Filters"}};
 
-bool operator==(const SourceVisibility &lhs, const QuickAccessSource *rhs)
-{
-	return lhs.source == rhs;
-}
-
 QuickAccessDock::QuickAccessDock(QWidget *parent, obs_data_t *obsData,
 				 bool modal)
 	: QFrame(parent),
@@ -43,57 +39,119 @@ QuickAccessDock::QuickAccessDock(QWidget *parent, obs_data_t *obsData,
 	_showScenes = obs_data_get_bool(obsData, "show_scenes");
 	_clickableScenes = obs_data_get_bool(obsData, "clickable_scenes");
 
+	_currentScene = qau->GetCurrentScene();
+
+	if (_dockType == "Manual") {
+		// Only the saved source list is kept until the dock is built.
+		_pendingSources = obs_data_get_array(obsData, "dock_sources");
+	}
+
+	setMinimumWidth(200);
+	auto l = new QVBoxLayout;
+	l->setContentsMargins(0, 0, 0, 0);
+	setLayout(l);
+
+	if (!_modal) {
+		DrawDock(obsData);
+	}
+
+	// Hidden docks are built the first time they are shown.
+	if (_modal || !obs_data_get_bool(obsData, "dock_hidden")) {
+		_Build();
+	}
+}
+
+void QuickAccessDock::_Build()
+{
+	if (_ready) {
+		return;
+	}
+	// Set first so the loaders below see a live dock.
+	_ready = true;
+
 	InitializeSearch();
 
 	if (_dockType == "Manual") {
-		obs_data_array_t *items =
-			obs_data_get_array(obsData, "dock_sources");
-		auto numItems = obs_data_array_count(items);
+		auto numItems = obs_data_array_count(_pendingSources);
 		for (size_t i = 0; i < numItems; i++) {
-			auto item = obs_data_array_item(items, i);
-			auto sourceName =
-				obs_data_get_string(item, "source_name");
-			auto source = obs_get_source_by_name(sourceName);
+			auto item = obs_data_array_item(_pendingSources, i);
+			// Entries saved before source_uuid existed only have
+			// a name to go by.
+			std::string uuid =
+				obs_data_get_string(item, "source_uuid");
+			QuickAccessSource *source =
+				uuid.empty() ? nullptr : qau->GetSource(uuid);
 			if (!source) {
-				continue;
+				auto obsSource = obs_get_source_by_name(
+					obs_data_get_string(item,
+							    "source_name"));
+				if (obsSource) {
+					source = qau->GetSource(
+						obs_source_get_uuid(obsSource));
+					obs_source_release(obsSource);
+				}
 			}
-			std::string id = obs_source_get_uuid(source);
-			_sources.push_back(qau->GetSource(id));
-			obs_source_release(source);
 			obs_data_release(item);
+			if (source) {
+				_sources.push_back(source);
+			}
 		}
-		std::vector<SourceVisibility> sourceStates;
-		for (auto &source : _sources) {
-			sourceStates.push_back({source, nullptr, true});
-		}
-		_displayGroups.push_back({"Manual", SearchType::None, nullptr,
-					  false, sourceStates, _sources});
-		obs_data_array_release(items);
+		_displayGroups.push_back({"Manual", SearchType::None});
+		obs_data_array_release(_pendingSources);
+		_pendingSources = nullptr;
 		for (auto &source : _sources) {
 			source->addDock(this);
 		}
 	} else if (_dockType == "Dynamic") {
-		_currentScene = qau->GetCurrentScene();
 		UpdateDynamicDock(false);
 	}
 
-	if (!_modal) {
-		DrawDock(obsData);
-	}
-
 	_widget = new QuickAccess(this, this, "quick_access_widget");
 	//_widget->setStyleSheet("border: 1px solid #FFFFFF;");
-	setMinimumWidth(200);
-	auto l = new QVBoxLayout;
-	l->setContentsMargins(0, 0, 0, 0);
-	l->addWidget(_widget);
-	setLayout(l);
+	layout()->addWidget(_widget);
+}
 
-	_ready = true;
+bool QuickAccessDock::eventFilter(QObject *obj, QEvent *event)
+{
+	switch (event->type()) {
+	case QEvent::Move:
+	case QEvent::Resize:
+	case QEvent::Show:
+	case QEvent::Hide:
+	case QEvent::ParentChange:
+		_saveDirty = true;
+		break;
+	default:
+		break;
+	}
+	return QFrame::eventFilter(obj, event);
+}
+
+void QuickAccessDock::showEvent(QShowEvent *event)
+{
+	_Build();
+	if (_dirty) {
+		_Reconcile();
+	}
+	QFrame::showEvent(event);
+}
+
+void QuickAccessDock::_Reconcile()
+{
+	// Catch up on everything skipped while the dock was not visible in
+	// one pass.  Rows that are unchanged are left alone.
+	_dirty = false;
+	if (_dockType == "Dynamic") {
+		UpdateDynamicDock(true);
+	} else if (_dockType == "Source Search" && _widget) {
+		_ApplySources(qau->GetAllSources());
+	}
 }
 
 QuickAccessDock::~QuickAccessDock()
 {
+	obs_data_array_release(_pendingSources);
+	obs_data_release(_saveData);
 	_ClearSources();
 	if (_dockWidget) {
 		delete _dockWidget;
@@ -102,36 +160,27 @@ QuickAccessDock::~QuickAccessDock()
 
 size_t QuickAccessDock::SourceCount()
 {
-	size_t sourceCount = 0;
-	for (auto &dg : _displayGroups) {
-		sourceCount += dg.sources2.size();
-	}
-	return sourceCount;
+	return _sources.size();
 }
 
 void QuickAccessDock::InitializeSearch()
 {
-	if (_dockType != "Source Search") {
+	if (_dockType != "Source Search" || !_ready) {
 		return;
 	}
+	_ClearSources();
 	_sources = qau->GetAllSources();
 	std::sort(_sources.begin(), _sources.end(),
-		  [](QuickAccessSource *a, QuickAccessSource *b) {
-			  return a->getName() < b->getName();
-		  });
-	std::vector<SourceVisibility> sources;
+		  QuickAccessSource::sortLess);
 	for (auto &source : _sources) {
 		source->addDock(this);
-		sources.push_back({source, nullptr, false});
 	}
 	_displayGroups.clear();
-	_indexer.clear();
-	size_t i = 0;
 	for (auto &st : SearchTypes) {
-		_displayGroups.push_back({SearchTypeNames.at(st), st, nullptr,
-					  false, sources, _sources});
-		_indexer[st] = i;
-		i++;
+		_displayGroups.push_back({SearchTypeNames.at(st), st});
+	}
+	if (_widget) {
+		_widget->Load();
 	}
 }
 
@@ -142,9 +191,12 @@ void QuickAccessDock::SetCurrentScene(QuickAccessSource *currentScene)
 		return;
 	}
 	if (_dockType == "Dynamic") {
+		if (!isVisible()) {
+			_dirty = true;
+			return;
+		}
 		UpdateDynamicDock(true);
 	}
-	// Set up dynamic dock here.
 }
 
 void QuickAccessDock::SearchFocus()
@@ -157,6 +209,7 @@ void QuickAccessDock::SearchFocus()
 void QuickAccessDock::SetName(std::string name)
 {
 	_dockName = name;
+	_saveDirty = true;
 	auto d = parentWidget();
 	if (d) {
 		d->setWindowTitle(name.c_str());
@@ -167,6 +220,10 @@ void QuickAccessDock::CleanupSourceHandlers() {}
 
 void QuickAccessDock::SetItemsButtonVisibility()
 {
+	if (!isVisible()) {
+		_dirty = true;
+		return;
+	}
 	if (_widget) {
 		_widget->SetItemsButtonVisibility();
 	}
@@ -195,32 +252,6 @@ void QuickAccessDock::Load(obs_data_t *obsData, bool created)
 	DrawDock(obsData);
 }
 
-void QuickAccessDock::Search(std::string searchTerm)
-{
-	for (auto &source : _sources) {
-		source->BuildSearchTerms();
-	}
-	for (auto &dg : _displayGroups) {
-		dg.headerVisible = false;
-		for (auto &source : dg.sources) {
-			source.visible = false;
-		}
-	}
-	size_t i = 0;
-	for (auto &source : _sources) {
-		for (auto &st : source->search(searchTerm)) {
-			_displayGroups[_indexer[st]].sources[i].visible = true;
-			_displayGroups[_indexer[st]].headerVisible = true;
-		}
-		i++;
-	}
-	if (_widget) {
-		QMetaObject::invokeMethod(
-			QCoreApplication::instance()->thread(),
-			[this]() { _widget->UpdateVisibility(); });
-	}
-}
-
 void QuickAccessDock::DrawDock(obs_data_t *obsData)
 {
 	const auto mainWindow =
@@ -232,6 +263,8 @@ void QuickAccessDock::DrawDock(obs_data_t *obsData)
 	_dockInjected = true;
 
 	const auto d = static_cast<QDockWidget *>(parentWidget());
+	// Placement changes need a fresh save.
+	d->installEventFilter(this);
 
 	if (obs_data_get_bool(obsData, "dock_hidden")) {
 		d->hide();
@@ -260,9 +293,22 @@ void QuickAccessDock::DrawDock(obs_data_t *obsData)
 void QuickAccessDock::Save(obs_data_t *obsData)
 {
 	std::unique_lock lock(_m);
+	// OBS saves often, so the dock's data is only rebuilt after its
+	// config, sources or placement changed.
+	if (_saveDirty || !_saveData) {
+		obs_data_release(_saveData);
+		_saveData = _BuildSaveData();
+		_saveDirty = false;
+	}
+	auto docks = obs_data_get_array(obsData, "docks");
+	obs_data_array_push_back(docks, _saveData);
+	obs_data_array_release(docks);
+}
+
+obs_data_t *QuickAccessDock::_BuildSaveData()
+{
 	const auto mainWindow =
 		static_cast<QMainWindow *>(obs_frontend_get_main_window());
-	auto docks = obs_data_get_array(obsData, "docks");
 	auto dockData = obs_data_create();
 	obs_data_set_string(dockData, "dock_name", _dockName.c_str());
 	obs_data_set_string(dockData, "dock_type", _dockType.c_str());
@@ -290,9 +336,14 @@ void QuickAccessDock::Save(obs_data_t *obsData)
 	obs_data_set_bool(dockData, "dock_floating",
 			  ((QDockWidget *)parentWidget())->isFloating());
 
-	if (_dockType == "Manual" && _displayGroups.size() != 0) {
+	if (_dockType == "Manual" && !_ready) {
+		if (_pendingSources) {
+			obs_data_set_array(dockData, "dock_sources",
+					   _pendingSources);
+		}
+	} else if (_dockType == "Manual") {
 		auto itemsArr = obs_data_array_create();
-		for (auto &source : _displayGroups[0].sources2) {
+		for (auto &source : _sources) {
 			auto itemObj = obs_data_create();
 			source->save(itemObj);
 			obs_data_array_push_back(itemsArr, itemObj);
@@ -302,53 +353,59 @@ void QuickAccessDock::Save(obs_data_t *obsData)
 		obs_data_array_release(itemsArr);
 	}
 
-	obs_data_array_push_back(docks, dockData);
-	obs_data_release(dockData);
-	obs_data_array_release(docks);
+	return dockData;
 }
 
 void QuickAccessDock::SourceCreated(QuickAccessSource *source)
 {
-	if (_dockType == "Source Search") {
+	if (_dockType == "Source Search" && _ready) {
+		if (!isVisible()) {
+			_dirty = true;
+			return;
+		}
 		AddSource(source);
 	}
 }
 
 void QuickAccessDock::SourceDestroyed(QuickAccessSource *source)
 {
+	if (_widget) {
+		_widget->SourceDestroyed(source);
+	}
 	if (_dockType == "Search Source" || _dockType == "Manual") {
 		RemoveSource(source);
 	}
 	// TODO: Handle Dynamic Dock.
 }
 
-void QuickAccessDock::SourceUpdate() {}
-
 void QuickAccessDock::SourceRename(QuickAccessSource *source)
 {
-	UNUSED_PARAMETER(source);
-	// Dynamic sources are handled from scene item add/delete events
+	if (_dockType == "Manual") {
+		_saveDirty = true;
+	}
 	if (_switchingSC || !_widget) {
 		return;
 	}
-	_widget->Redraw();
+	if (_OwnsSources() && _dockType != "Manual") {
+		// Keep the search order for the new name.
+		auto it = std::find(_sources.begin(), _sources.end(), source);
+		if (it != _sources.end()) {
+			_sources.erase(it);
+			it = std::upper_bound(_sources.begin(), _sources.end(),
+					      source,
+					      QuickAccessSource::sortLess);
+			_sources.insert(it, source);
+		}
+	}
+	// Only the renamed row is refreshed, hidden docks paint it later.
+	_widget->SourceChanged(source);
 }
 
 void QuickAccessDock::RemoveSource(QuickAccessSource *source, bool removeDock)
 {
 	std::unique_lock lock(_m);
-	for (auto &group : _displayGroups) {
-		auto it = std::find(group.sources.begin(), group.sources.end(),
-				    source);
-		if (it != group.sources.end()) {
-			_widget->RemoveSource(source, group.name);
-			group.sources.erase(it);
-		}
-	}
-	if (auto it = std::find(_sources.begin(), _sources.end(), source);
-	    it != _sources.end()) {
-		_sources.erase(it);
-	}
+	_saveDirty = true;
+	_RemoveFromSources(source);
 	if (removeDock) {
 		source->removeDock(this);
 	}
@@ -361,75 +418,145 @@ void QuickAccessDock::AddSource(QuickAccessSource *source, int index)
 		    _sources.end()) {
 			return;
 		}
-		if (index == -1) {
-			_sources.push_back(source);
-			_displayGroups[0].sources.push_back(
-				{source, nullptr, true});
-		} else {
-			_sources.insert(_sources.begin() + index, source);
-			_displayGroups[0].sources.insert(
-				_displayGroups[0].sources.begin() + index,
-				{source, nullptr, true});
-		}
-		_widget->AddSource(source, _displayGroups[0].name);
-		source->addDock(this);
-	} else if (_dockType == "Source Search") {
-		auto sIt = _sources.begin();
-		while (sIt != _sources.end()) {
-			if ((*sIt)->getName() > source->getName()) {
-				break;
+	} else if (_dockType != "Source Search") {
+		return;
+	}
+
+	_AddToSources(source, true, index);
+	source->addDock(this);
+	_saveDirty = true;
+}
+
+bool QuickAccessDock::_OwnsSources() const
+{
+	// The widget's model owns edits to _sources, except in search docks,
+	// whose widgets only show the matches (Quick Search ranks its own
+	// list, Source Search publishes a copy a chunk at a time).
+	return !_widget || _dockType == "Source Search";
+}
+
+void QuickAccessDock::_AddToSources(QuickAccessSource *source,
+				    bool updateWidget, int index)
+{
+	if (_OwnsSources()) {
+		if (_dockType == "Manual") {
+			auto it = _sources.end();
+			if (index >= 0 &&
+			    index < static_cast<int>(_sources.size())) {
+				it = _sources.begin() + index;
 			}
-			sIt++;
+			_sources.insert(it, source);
+		} else {
+			_sources.insert(
+				std::upper_bound(_sources.begin(),
+						 _sources.end(), source,
+						 QuickAccessSource::sortLess),
+				source);
 		}
+	}
+	if (_widget && updateWidget) {
+		_widget->AddSource(source, index);
+	}
+}
 
-		// Add the source to the dock's raw source list.
-		_sources.insert(sIt, source);
+void QuickAccessDock::_RemoveFromSources(QuickAccessSource *source)
+{
+	if (_OwnsSources()) {
+		auto it = std::find(_sources.begin(), _sources.end(), source);
+		if (it != _sources.end()) {
+			_sources.erase(it);
+		}
+	}
+	if (_widget) {
+		_widget->RemoveSource(source);
+	}
+}
 
-		// Then add to each of the search display groups.
-		for (auto &dg : _displayGroups) {
-			auto it = dg.sources.begin();
+void QuickAccessDock::AddSources(const std::vector<QuickAccessSource *> &sources)
+{
+	if (_dockType != "Manual") {
+		for (auto &source : sources) {
+			AddSource(source);
+		}
+		return;
+	}
 
-			// Find location to insert
-			while (it != dg.sources.end()) {
-				if (it->source->getName() > source->getName()) {
-					break;
-				}
-				it++;
-			}
-			//int index = it - dg.sources.begin();
-			dg.sources.insert(it, {source, nullptr, false});
-			_widget->AddSource(source, dg.name);
+	std::unordered_set<QuickAccessSource *> existing(_sources.begin(),
+							 _sources.end());
+	std::vector<QuickAccessSource *> added;
+	for (auto &source : sources) {
+		if (source && existing.insert(source).second) {
+			added.push_back(source);
 		}
+	}
+	// New sources go to the top, in the order they were picked.
+	if (_widget) {
+		_widget->AddSources(added, 0);
+	} else {
+		_sources.insert(_sources.begin(), added.begin(), added.end());
+	}
+	for (auto &source : added) {
 		source->addDock(this);
 	}
+	_saveDirty = true;
 }
 
 void QuickAccessDock::UpdateDynamicDock(bool updateWidget)
 {
-	_ClearSources();
+	std::vector<QuickAccessSource *> sources;
 	if (_currentScene) {
-		// _currentScene is not set up with links to children.
-		// so grab the fully populated version from qau->GetSource
-		/*QuickAccessSource *cur =
-			qau->GetSource(_currentScene->getUUID());*/
-		//_AddToDynDock(_currentScene);
-		_sources = qau->GetCurrentSceneSources();
+		sources = qau->GetCurrentSceneSources();
+	}
+	_displayGroups.clear();
+	//_displayGroups.push_back({ "DSK" });
+	_displayGroups.push_back({"Scene", SearchType::None});
+	if (!updateWidget || !_widget) {
+		// Scene closures are already sorted.
+		_ClearSources();
+		_sources = sources;
 		for (auto &source : _sources) {
 			source->addDock(this);
 		}
+		return;
 	}
-	_displayGroups.clear();
-	//_displayGroups.push_back({ "DSK" });
-	std::vector<SourceVisibility> sourceStates;
+	QMetaObject::invokeMethod(
+		QCoreApplication::instance()->thread(),
+		[this, sources]() { _ApplySources(sources); });
+}
+
+void QuickAccessDock::_ApplySources(
+	const std::vector<QuickAccessSource *> &sources)
+{
+	// Most sources are usually unchanged (scenes share most of theirs),
+	// so only the difference is applied to the widget's model instead
+	// of rebuilding the list.
+	std::unique_lock lock(_m);
+	std::unordered_set<QuickAccessSource *> next(sources.begin(),
+						     sources.end());
+	std::vector<QuickAccessSource *> removed;
 	for (auto &source : _sources) {
-		sourceStates.push_back({source, nullptr, true});
-	}
-	_displayGroups.push_back({"Scene", SearchType::None, nullptr, true,
-				  sourceStates, _sources});
-	if (updateWidget) {
-		QMetaObject::invokeMethod(
-			QCoreApplication::instance()->thread(),
-			[this]() { _widget->Load(); });
+		if (next.find(source) == next.end()) {
+			removed.push_back(source);
+		}
+	}
+	for (auto &source : removed) {
+		_RemoveFromSources(source);
+		source->removeDock(this);
+	}
+
+	std::unordered_set<QuickAccessSource *> current(_sources.begin(),
+							_sources.end());
+	bool added = false;
+	for (auto &source : sources) {
+		if (current.insert(source).second) {
+			// The modal re-ranks once below instead of per source.
+			_AddToSources(source, !_modal);
+			source->addDock(this);
+			added = true;
+		}
+	}
+	if (_modal && added) {
+		_widget->RefreshSearch();
 	}
 }
 
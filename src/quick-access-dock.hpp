@@ -4,7 +4,6 @@
 
 #include <QDockWidget>
 #include <QWidget>
-#include <QListWidgetItem>
 #include <QFrame>
 #include <string>
 #include <map>
@@ -19,21 +18,9 @@ class QuickAccess;
 typedef const char *(*translateFunc)(const char *);
 class QuickAccessSource;
 
-struct SourceVisibility {
-	QuickAccessSource *source;
-	QListWidgetItem *listItem;
-	bool visible;
-};
-
-bool operator==(const SourceVisibility &lhs, const QuickAccessSource *rhs);
-
 struct QuickAccessItemGroup {
 	std::string name;
 	SearchType searchType;
-	QListWidgetItem *headerItem;
-	bool headerVisible;
-	std::vector<SourceVisibility> sources;
-	std::vector<QuickAccessSource *> sources2;
 };
 
 class QuickAccessDock : public QFrame {
@@ -53,45 +40,78 @@ public:
 	inline bool ShowFilters() { return _showFilters; }
 	inline bool ShowScenes() { return _showScenes; }
 	inline bool ClickableScenes() { return _clickableScenes; }
-	inline void SetProperties(bool on) { _showProperties = on; }
-	inline void SetFilters(bool on) { _showFilters = on; }
-	inline void SetScenes(bool on) { _showScenes = on; }
-	inline void SetClickableScenes(bool on) { _clickableScenes = on; }
+	inline bool IsModal() const { return _modal; }
+	inline void SetProperties(bool on)
+	{
+		_showProperties = on;
+		_saveDirty = true;
+	}
+	inline void SetFilters(bool on)
+	{
+		_showFilters = on;
+		_saveDirty = true;
+	}
+	inline void SetScenes(bool on)
+	{
+		_showScenes = on;
+		_saveDirty = true;
+	}
+	inline void SetClickableScenes(bool on)
+	{
+		_clickableScenes = on;
+		_saveDirty = true;
+	}
+	inline void MarkDirty() { _saveDirty = true; }
 	void SetCurrentScene(QuickAccessSource *currentScene);
 	void SetName(std::string name);
 	inline QDockWidget *GetDockWidget() { return _dockWidget; }
 	void SwitchingSceneCollections(bool state) { _switchingSC = state; }
-	inline std::vector<QuickAccessSource *> Sources() { return _sources; }
+	inline std::vector<QuickAccessSource *> &Sources() { return _sources; }
 	inline auto &DisplayGroups() { return _displayGroups; }
 	void SetItemsButtonVisibility();
 
 	void SourceCreated(QuickAccessSource *source);
 	void SourceDestroyed(QuickAccessSource *source);
-	void SourceUpdate();
 	void SourceRename(QuickAccessSource *source);
 	void CleanupSourceHandlers();
 	void RemoveSource(QuickAccessSource *source, bool removeDock = true);
 	void AddSource(QuickAccessSource *source, int index = -1);
+	void AddSources(const std::vector<QuickAccessSource *> &sources);
 	void UpdateDynamicDock(bool updateWidget = true);
-	void Search(std::string searchTerm);
 	void SearchFocus();
 	void DismissModal();
 	size_t SourceCount();
 	void DrawDock(obs_data_t *obsData);
 
+protected:
+	void showEvent(QShowEvent *event) override;
+	bool eventFilter(QObject *obj, QEvent *event) override;
+
 private:
+	void _Build();
+	obs_data_t *_BuildSaveData();
 	void _ClearSources();
 	void _AddToDynDock(QuickAccessSource *source);
+	void _ApplySources(const std::vector<QuickAccessSource *> &sources);
+	bool _OwnsSources() const;
+	void _AddToSources(QuickAccessSource *source, bool updateWidget = true,
+			   int index = -1);
+	void _RemoveFromSources(QuickAccessSource *source);
+	void _Reconcile();
 
 	QDockWidget *_dockWidget = nullptr;
 	QuickAccess *_widget = nullptr;
 	std::vector<QuickAccessSource *> _sources;
 	std::vector<QuickAccessItemGroup> _displayGroups;
+	obs_data_array_t *_pendingSources = nullptr;
+	// Serialized dock, reused by Save until something changes.
+	obs_data_t *_saveData = nullptr;
+	bool _saveDirty = true;
 	std::mutex _m;
 	std::string _dockName;
 	std::string _dockType;
 	std::string _dockId;
-	QuickAccessSource *_currentScene;
+	QuickAccessSource *_currentScene = nullptr;
 	bool _showProperties = false;
 	bool _showFilters = false;
 	bool _showScenes = false;
@@ -100,5 +120,5 @@ private:
 	bool _switchingSC = false;
 	bool _modal = false;
 	bool _ready = false;
-	std::map<SearchType, size_t> _indexer;
+	bool _dirty = false;
 };
@@ -1,10 +1,14 @@
 #include "quick-access-source.hpp"
 #include "quick-access-utility.hpp"
 #include "quick-access-dock.hpp"
+#include "quick-access-trace.hpp"
 #include "version.h"
 
 #include <algorithm>
+#include <tuple>
+#include <queue>
 #include <QApplication>
+#include <QThread>
 #include <QEvent>
 #include <QMouseEvent>
 #include <QStringListModel>
@@ -15,6 +19,8 @@
 
 #define START_LOC 35
 #define INC 30
+// Characters kept in front of a match when showing why a row matched.
+#define MATCH_CONTEXT_CHARS 12
 
 extern QuickAccessUtility *qau;
 const std::vector<SearchType> SearchTypes{SearchType::Source, SearchType::Type,
@@ -34,25 +40,34 @@ QuickAccessSourceDelegate::QuickAccessSourceDelegate(QObject *parent,
 	: QStyledItemDelegate(parent),
 	  _dock(dock)
 {
-	_propertiesState = QStyle::State_Enabled;
-	_filtersState = QStyle::State_Enabled;
-	_parentScenesState = QStyle::State_Enabled;
 }
 
 void QuickAccessSourceDelegate::paint(QPainter *painter,
 				      const QStyleOptionViewItem &option,
 				      const QModelIndex &index) const
 {
-	const auto model =
-		static_cast<const QuickAccessSourceModel *>(index.model());
-	auto item = model->item(index.row());
+	QAU_TRACE_SCOPE("QuickAccessSourceDelegate::paint");
+	if (QuickAccessGroupedModel::isHeader(index)) {
+		QFont font = option.font;
+		font.setPixelSize(18);
+		painter->save();
+		painter->setFont(font);
+		painter->drawText(option.rect, Qt::AlignCenter,
+				  index.data(Qt::DisplayRole).toString());
+		painter->restore();
+		return;
+	}
+	auto item = QuickAccessSourceModel::sourceAt(index);
+	if (!item) {
+		return;
+	}
 	std::string mode = obs_frontend_is_theme_dark() ? "theme:Dark/"
 							: "theme:Light/";
 	QString text = item->getName().c_str();
 	QRect rect = option.rect;
 	if (option.state & QStyle::State_Selected)
 		painter->fillRect(option.rect, option.palette.highlight());
-	if (option.state & QStyle::State_MouseOver)
+	if ((option.state & QStyle::State_MouseOver) || _hoverIndex == index)
 		painter->fillRect(option.rect, option.palette.highlight());
 	auto icon = item->icon();
 	QRect iconRect(rect);
@@ -67,11 +82,17 @@ void QuickAccessSourceDelegate::paint(QPainter *painter,
 	textRect.setWidth(rect.width() - 107);
 	textRect.setHeight(30);
 	textRect.setX(32);
-	painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, text);
+	auto match = index.data(QuickAccessSourceFilterModel::MatchRole);
+	if (match.isValid()) {
+		drawMatch(painter, textRect, text,
+			  match.value<QuickAccessMatchSpan>(), option.font);
+	} else {
+		painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter,
+				  text);
+	}
 
 	const QWidget *widget = option.widget;
-	QListWidget *lw = new QListWidget();
-	QStyle *style = lw ? lw->style() : QApplication::style();
+	QStyle *style = widget ? widget->style() : QApplication::style();
 
 	int loc = START_LOC;
 	int inc = INC;
@@ -90,8 +111,8 @@ void QuickAccessSourceDelegate::paint(QPainter *painter,
 
 		parentScenesButton.icon = scenesIcon;
 		parentScenesButton.iconSize = QSize(16, 16);
-		parentScenesButton.state = _filtersState |
-					   QStyle::State_Enabled;
+		parentScenesButton.state =
+			_buttonState(index, SourceButton::ParentScenes);
 		style->drawControl(QStyle::CE_PushButtonLabel,
 				   &parentScenesButton, painter, widget);
 		loc += inc;
@@ -110,7 +131,8 @@ void QuickAccessSourceDelegate::paint(QPainter *painter,
 				   QIcon::Normal, QIcon::Off);
 		filtersButton.icon = filterIcon;
 		filtersButton.iconSize = QSize(16, 16);
-		filtersButton.state = _filtersState | QStyle::State_Enabled;
+		filtersButton.state =
+			_buttonState(index, SourceButton::Filters);
 		style->drawControl(QStyle::CE_PushButtonLabel, &filtersButton,
 				   painter, widget);
 		loc += inc;
@@ -129,14 +151,13 @@ void QuickAccessSourceDelegate::paint(QPainter *painter,
 				  QIcon::Normal, QIcon::Off);
 		propertiesButton.icon = propsIcon;
 		propertiesButton.iconSize = QSize(16, 16);
-		propertiesButton.state = _propertiesState |
-					 QStyle::State_Enabled;
+		propertiesButton.state =
+			_buttonState(index, SourceButton::Properties);
 		style->drawControl(QStyle::CE_PushButtonLabel,
 				   &propertiesButton, painter, widget);
 		loc += inc;
 	}
 	textRect.setWidth(rect.width() - (loc + 2));
-	delete lw;
 }
 
 QSize QuickAccessSourceDelegate::sizeHint(
@@ -148,6 +169,99 @@ QSize QuickAccessSourceDelegate::sizeHint(
 	return QSize(200, 30);
 }
 
+void QuickAccessSourceDelegate::drawMatch(QPainter *painter, QRect rect,
+					  const QString &name,
+					  const QuickAccessMatchSpan &span,
+					  const QFont &font) const
+{
+	// The matched part is bold, in the name when that is what matched,
+	// otherwise in the matched value (a UUID included) shown after the
+	// name.
+	QFont bold(font);
+	bold.setBold(true);
+	painter->save();
+	painter->setClipRect(rect);
+	auto drawRun = [painter, &rect](const QString &run, const QFont &f) {
+		painter->setFont(f);
+		painter->drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, run);
+		rect.setLeft(rect.left() +
+			     QFontMetrics(f).horizontalAdvance(run));
+	};
+	auto drawSpan = [&](const QString &text) {
+		drawRun(text.left(span.start), font);
+		drawRun(text.mid(span.start, span.length), bold);
+		drawRun(text.mid(span.start + span.length), font);
+	};
+	if (span.searchType == SearchType::Source && span.text == name) {
+		drawSpan(name);
+	} else {
+		drawRun(name + "  ", font);
+		painter->setOpacity(0.7);
+		drawSpan(span.text);
+	}
+	painter->restore();
+}
+
+SourceButton QuickAccessSourceDelegate::buttonAt(const QModelIndex &index,
+						 const QRect &rect,
+						 const QPoint &pos) const
+{
+	auto item = QuickAccessSourceModel::sourceAt(index);
+	if (!item) {
+		return SourceButton::None;
+	}
+	int loc = START_LOC;
+	int inc = INC;
+
+	// Same buttons, in the same order, as paint lays them out.
+	const std::pair<bool, SourceButton> buttons[] = {
+		{_dock->ShowScenes(), SourceButton::ParentScenes},
+		{_dock->ShowFilters(), SourceButton::Filters},
+		{_dock->ShowProperties() && item->hasProperties(),
+		 SourceButton::Properties}};
+
+	for (auto &[shown, button] : buttons) {
+		if (!shown) {
+			continue;
+		}
+		QRect buttonRect(rect);
+		buttonRect.setX(rect.width() - loc);
+		buttonRect.setWidth(30);
+		buttonRect.setHeight(30);
+		if (buttonRect.contains(pos)) {
+			return button;
+		}
+		loc += inc;
+	}
+	return SourceButton::None;
+}
+
+bool QuickAccessSourceDelegate::setHover(const QModelIndex &index,
+					 SourceButton button)
+{
+	if (_hoverIndex == index && button == _hoverButton) {
+		return false;
+	}
+	_hoverIndex = index;
+	_hoverButton = button;
+	return true;
+}
+
+QStyle::State
+QuickAccessSourceDelegate::_buttonState(const QModelIndex &index,
+					SourceButton button) const
+{
+	QStyle::State state = QStyle::State_Enabled;
+	if (button == _pressedButton && _pressedIndex == index) {
+		return state | QStyle::State_Sunken;
+	}
+	state |= QStyle::State_Raised;
+	if (button == _hoverButton && _hoverIndex == index) {
+		state |= QStyle::State_MouseOver;
+	}
+	return state;
+}
+
 bool QuickAccessSourceDelegate::editorEvent(QEvent *event,
 					    QAbstractItemModel *model,
 					    const QStyleOptionViewItem &option,
@@ -157,73 +271,40 @@ bool QuickAccessSourceDelegate::editorEvent(QEvent *event,
 	if (event->type() != QEvent::MouseButtonPress &&
 	    event->type() != QEvent::MouseButtonRelease &&
 	    event->type() != QEvent::MouseButtonDblClick) {
-		//ignoring other mouse event and reseting button's state
-		_propertiesState = QStyle::State_Raised;
-		_filtersState = QStyle::State_Raised;
-		_parentScenesState = QStyle::State_Raised;
+		// Hover is tracked by the view, so there is nothing to
+		// reset (or repaint) here.
+		return false;
+	}
+	if (QuickAccessGroupedModel::isHeader(index)) {
 		return true;
 	}
 
 	QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+	SourceButton button = buttonAt(index, option.rect, mouseEvent->pos());
 
-	int loc = START_LOC;
-	int inc = INC;
+	if (event->type() == QEvent::MouseButtonPress) {
+		_pressedIndex = index;
+		_pressedButton = button;
+		return true;
+	}
 
 	if (event->type() == QEvent::MouseButtonRelease) {
+		_pressedIndex = QModelIndex();
+		_pressedButton = SourceButton::None;
 		emit itemSelected(index);
-	}
 
-	if (_dock->ShowScenes()) {
-		QRect parentScenesButtonRect(option.rect);
-		parentScenesButtonRect.setX(option.rect.width() - loc);
-		parentScenesButtonRect.setWidth(30);
-		parentScenesButtonRect.setHeight(30);
-
-		if (!parentScenesButtonRect.contains(mouseEvent->pos())) {
-			_parentScenesState = QStyle::State_Raised;
-		} else if (event->type() == QEvent::MouseButtonPress) {
-			_parentScenesState = QStyle::State_Sunken;
-		} else if (event->type() == QEvent::MouseButtonRelease) {
-			_parentScenesState = QStyle::State_Raised;
+		switch (button) {
+		case SourceButton::ParentScenes:
 			emit openParentScenesClicked(index);
 			return true;
-		}
-		loc += inc;
-	}
-
-	if (_dock->ShowFilters()) {
-
-		QRect filtersButtonRect(option.rect);
-		filtersButtonRect.setX(option.rect.width() - loc);
-		filtersButtonRect.setWidth(30);
-		filtersButtonRect.setHeight(30);
-
-		if (!filtersButtonRect.contains(mouseEvent->pos())) {
-			_filtersState = QStyle::State_Raised;
-		} else if (event->type() == QEvent::MouseButtonPress) {
-			_filtersState = QStyle::State_Sunken;
-		} else if (event->type() == QEvent::MouseButtonRelease) {
-			_filtersState = QStyle::State_Raised;
+		case SourceButton::Filters:
 			emit openFiltersClicked(index);
 			return true;
-		}
-		loc += inc;
-	}
-
-	if (_dock->ShowProperties()) {
-		QRect propertiesButtonRect(option.rect);
-		propertiesButtonRect.setX(option.rect.width() - loc);
-		propertiesButtonRect.setWidth(30);
-		propertiesButtonRect.setHeight(30);
-
-		if (!propertiesButtonRect.contains(mouseEvent->pos())) {
-			_propertiesState = QStyle::State_Raised;
-		} else if (event->type() == QEvent::MouseButtonPress) {
-			_propertiesState = QStyle::State_Sunken;
-		} else if (event->type() == QEvent::MouseButtonRelease) {
-			_propertiesState = QStyle::State_Raised;
+		case SourceButton::Properties:
 			emit openPropertiesClicked(index);
 			return true;
+		default:
+			break;
 		}
 	}
 
@@ -237,10 +318,8 @@ bool QuickAccessSourceDelegate::editorEvent(QEvent *event,
 	return true;
 }
 
-QuickAccessSourceModel::QuickAccessSourceModel(QObject *parent,
-					       SearchType searchType)
-	: QAbstractListModel(parent),
-	  _searchType(searchType)
+QuickAccessSourceModel::QuickAccessSourceModel(QObject *parent)
+	: QAbstractListModel(parent)
 {
 }
 
@@ -299,37 +378,134 @@ bool QuickAccessSourceModel::removeRows(int row, int count,
 	return true;
 }
 
-void QuickAccessSourceModel::swapRows(int rowA, int rowB)
+bool QuickAccessSourceModel::moveRows(const QModelIndex &sourceParent,
+				      int sourceRow, int count,
+				      const QModelIndex &destinationParent,
+				      int destinationChild)
 {
+	if (sourceParent.isValid() || destinationParent.isValid() ||
+	    count <= 0 || sourceRow < 0 || sourceRow + count > rowCount() ||
+	    destinationChild < 0 || destinationChild > rowCount()) {
+		return false;
+	}
+	if (!beginMoveRows(sourceParent, sourceRow, sourceRow + count - 1,
+			   destinationParent, destinationChild)) {
+		return false;
+	}
 	auto &data = *_data;
-	beginResetModel();
-	std::swap(data[rowA], data[rowB]);
-	endResetModel();
+	auto first = data.begin() + sourceRow;
+	auto last = first + count;
+	if (destinationChild < sourceRow) {
+		std::rotate(data.begin() + destinationChild, first, last);
+	} else {
+		std::rotate(first, last, data.begin() + destinationChild);
+	}
+	endMoveRows();
+	return true;
 }
 
-void QuickAccessSourceModel::addSource(QuickAccessSource *source)
+void QuickAccessSourceModel::addSource(QuickAccessSource *source, int row)
 {
-	// TODO: Insert alphabatized
-	beginInsertRows(QModelIndex(), rowCount(), rowCount());
-	_data->push_back(source);
+	auto &data = *_data;
+	auto it = data.end();
+	if (_sorted) {
+		it = std::upper_bound(data.begin(), data.end(), source,
+				      QuickAccessSource::sortLess);
+	} else if (row >= 0 && row < rowCount()) {
+		it = data.begin() + row;
+	}
+	int idx = static_cast<int>(it - data.begin());
+	beginInsertRows(QModelIndex(), idx, idx);
+	data.insert(it, source);
 	endInsertRows();
 }
 
-void QuickAccessSourceModel::removeSource(QuickAccessSource *source)
+void QuickAccessSourceModel::addSources(
+	const std::vector<QuickAccessSource *> &sources, int row)
 {
-	auto it = std::find(_data->begin(), _data->end(), source);
-	if (it == _data->end()) {
+	if (sources.empty()) {
 		return;
 	}
-	int idx = static_cast<int>(it - _data->begin());
+	if (_sorted &&
+	    (!std::is_sorted(sources.begin(), sources.end(),
+			     QuickAccessSource::sortLess) ||
+	     (!_data->empty() &&
+	      QuickAccessSource::sortLess(sources.front(), _data->back())))) {
+		for (auto &source : sources) {
+			addSource(source);
+		}
+		return;
+	}
+	// Inserted as one block so views only lay out once, a sorted run
+	// that goes after every row is still in order.
+	int first = !_sorted && row >= 0 && row < rowCount() ? row
+							     : rowCount();
+	beginInsertRows(QModelIndex(), first,
+			first + static_cast<int>(sources.size()) - 1);
+	_data->insert(_data->begin() + first, sources.begin(), sources.end());
+	endInsertRows();
+}
+
+void QuickAccessSourceModel::removeSource(QuickAccessSource *source)
+{
+	auto &data = *_data;
+	auto first = data.begin();
+	auto last = data.end();
+	if (_sorted) {
+		std::tie(first, last) =
+			std::equal_range(data.begin(), data.end(), source,
+					 QuickAccessSource::sortLess);
+	}
+	auto it = std::find(first, last, source);
+	if (it == last) {
+		// The sort key may have changed since the source was
+		// inserted, fall back to a full scan.
+		it = std::find(data.begin(), data.end(), source);
+		if (it == data.end()) {
+			return;
+		}
+	}
+	int idx = static_cast<int>(it - data.begin());
 	beginRemoveRows(QModelIndex(), idx, idx);
-	_data->erase(it);
+	data.erase(it);
 	endRemoveRows();
 }
 
-void QuickAccessSourceModel::setSearchTerm(std::string searchTerm)
+void QuickAccessSourceModel::resetSources(
+	std::vector<QuickAccessSource *> sources)
 {
-	UNUSED_PARAMETER(searchTerm);
+	beginResetModel();
+	*_data = std::move(sources);
+	endResetModel();
+}
+
+void QuickAccessSourceModel::sourceChanged(QuickAccessSource *source)
+{
+	auto &data = *_data;
+	auto it = std::find(data.begin(), data.end(), source);
+	if (it == data.end()) {
+		return;
+	}
+	int row = static_cast<int>(it - data.begin());
+	if (_sorted) {
+		// Everything but the changed row is still in order, so only
+		// look for its new place on either side of it.
+		auto up = std::upper_bound(data.begin(), it, source,
+					   QuickAccessSource::sortLess);
+		auto down = std::upper_bound(it + 1, data.end(), source,
+					     QuickAccessSource::sortLess);
+		int dest = row;
+		if (up != it) {
+			dest = static_cast<int>(up - data.begin());
+		} else if (down != it + 1) {
+			dest = static_cast<int>(down - data.begin());
+		}
+		if (dest != row &&
+		    moveRows(QModelIndex(), row, 1, QModelIndex(), dest)) {
+			row = dest < row ? dest : dest - 1;
+		}
+	}
+	emit dataChanged(index(row), index(row));
 }
 
 int QuickAccessSourceModel::rowCount(const QModelIndex &parent) const
@@ -346,16 +522,410 @@ QuickAccessSource *QuickAccessSourceModel::item(int row) const
 	return _data->at(row);
 }
 
+QuickAccessSource *QuickAccessSourceModel::sourceAt(const QModelIndex &index)
+{
+	if (!index.isValid()) {
+		return nullptr;
+	}
+	return static_cast<QuickAccessSource *>(
+		index.data(Qt::UserRole).value<void *>());
+}
+
 QVariant QuickAccessSourceModel::data(const QModelIndex &index, int role) const
 {
-	UNUSED_PARAMETER(role);
 	if (index.row() < 0 || index.row() >= rowCount()) {
 		return {};
 	}
 
 	QuickAccessSource *ptr = _data->at(index.row());
-	QVariant qv(QVariant::fromValue(static_cast<void *>(ptr)));
-	return qv;
+	switch (role) {
+	case Qt::UserRole:
+		return QVariant::fromValue(static_cast<void *>(ptr));
+	case Qt::DisplayRole:
+		return QString::fromStdString(ptr->getName());
+	case Qt::DecorationRole:
+		return ptr->icon();
+	default:
+		return {};
+	}
+}
+
+QuickAccessSourceFilterModel::QuickAccessSourceFilterModel(
+	QObject *parent, SearchType searchType)
+	: QSortFilterProxyModel(parent),
+	  _searchType(searchType)
+{
+}
+
+void QuickAccessSourceFilterModel::setSearchTerm(std::string searchTerm)
+{
+	if (_searchType == SearchType::None || searchTerm == _searchTerm) {
+		return;
+	}
+	_searchTerm = searchTerm;
+	_results.reset();
+	invalidateFilter();
+}
+
+bool QuickAccessSourceFilterModel::filterAcceptsRow(
+	int sourceRow, const QModelIndex &sourceParent) const
+{
+	if (_searchType == SearchType::None) {
+		return true;
+	} else if (_searchTerm == "") {
+		return _matchEmpty;
+	}
+	UNUSED_PARAMETER(sourceParent);
+	auto model = static_cast<QuickAccessSourceModel *>(sourceModel());
+	auto source = model->item(sourceRow);
+	if (!source) {
+		return false;
+	}
+	if (_nameOnly) {
+		return QString::fromStdString(source->getName())
+			.contains(QString::fromStdString(_searchTerm),
+				  Qt::CaseInsensitive);
+	}
+	if (!_results || _results->generation != qau->SearchGeneration()) {
+		_results = qau->Search(_searchTerm);
+	}
+	return _results->hasMatch(source, _searchType);
+}
+
+QVariant QuickAccessSourceFilterModel::data(const QModelIndex &index,
+					    int role) const
+{
+	if (role != MatchRole) {
+		return QSortFilterProxyModel::data(index, role);
+	}
+	if (_searchType == SearchType::None || !_results) {
+		return {};
+	}
+	auto span = _results->span(QuickAccessSourceModel::sourceAt(index),
+				   _searchType);
+	return span ? QVariant::fromValue(*span) : QVariant();
+}
+
+const QuickAccessSearchHit &
+QuickAccessSearchResult::hit(QuickAccessSource *source) const
+{
+	QAU_TRACE_SCOPE("QuickAccessSearchResult::hit");
+	auto [it, inserted] = _hits.try_emplace(source);
+	if (inserted) {
+		auto &hit = it->second;
+		for (auto &st : SearchTypes) {
+			QuickAccessMatchSpan span;
+			if (source->findMatch(searchTerm, st, &span)) {
+				hit.types |= 1u << static_cast<int>(st);
+				hit.spans.push_back(std::move(span));
+			}
+		}
+	}
+	return it->second;
+}
+
+void QuickAccessSearchResult::evaluate(
+	const std::vector<QuickAccessSource *> &sources) const
+{
+	for (auto &source : sources) {
+		hit(source);
+	}
+}
+
+bool QuickAccessSearchResult::hasMatch(QuickAccessSource *source,
+				       SearchType st) const
+{
+	return hit(source).types & (1u << static_cast<int>(st));
+}
+
+const QuickAccessMatchSpan *
+QuickAccessSearchResult::span(QuickAccessSource *source, SearchType st) const
+{
+	auto it = _hits.find(source);
+	if (it == _hits.end()) {
+		return nullptr;
+	}
+	for (auto &span : it->second.spans) {
+		if (span.searchType == st) {
+			return &span;
+		}
+	}
+	return nullptr;
+}
+
+std::vector<QuickAccessSource *> QuickAccessSearchResult::top(size_t count) const
+{
+	// Ranked by the most important search type that matched, with UUID
+	// matches after every other type, then matches at the start of the
+	// value, earlier matches, shorter values and finally name.  Each
+	// source is only in _hits once.
+	typedef std::tuple<int, int, int, int> Rank;
+	struct Entry {
+		Rank rank;
+		QuickAccessSource *source;
+	};
+	auto better = [](const Entry &a, const Entry &b) {
+		if (a.rank != b.rank) {
+			return a.rank < b.rank;
+		}
+		return QuickAccessSource::sortLess(a.source, b.source);
+	};
+	// The worst of the entries kept so far is on top, so the heap never
+	// grows past count.
+	std::priority_queue<Entry, std::vector<Entry>, decltype(better)> heap(
+		better);
+	auto rankOf = [](const QuickAccessMatchSpan &span) {
+		int priority = static_cast<int>(
+			std::find(SearchTypes.begin(), SearchTypes.end(),
+				  span.searchType) -
+			SearchTypes.begin());
+		if (span.searchType == SearchType::Source && !span.inName) {
+			priority = static_cast<int>(SearchTypes.size());
+		}
+		return Rank(priority, span.start == 0 ? 0 : 1, span.start,
+			    static_cast<int>(span.text.size()));
+	};
+	for (auto &[source, hit] : _hits) {
+		if (hit.spans.empty() || count == 0) {
+			continue;
+		}
+		// Spans are in SearchTypes order, only a UUID match can be
+		// outranked by the span after it.
+		Rank rank = rankOf(hit.spans.front());
+		if (hit.spans.size() > 1) {
+			rank = std::min(rank, rankOf(hit.spans[1]));
+		}
+		Entry entry{rank, source};
+		if (heap.size() < count) {
+			heap.push(entry);
+		} else if (better(entry, heap.top())) {
+			heap.pop();
+			heap.push(entry);
+		}
+	}
+	std::vector<QuickAccessSource *> ranked(heap.size());
+	for (size_t i = ranked.size(); i > 0; i--) {
+		ranked[i - 1] = heap.top().source;
+		heap.pop();
+	}
+	return ranked;
+}
+
+QuickAccessGroupedModel::QuickAccessGroupedModel(QObject *parent)
+	: QAbstractListModel(parent)
+{
+}
+
+void QuickAccessGroupedModel::addGroup(std::string name,
+				       QAbstractItemModel *model,
+				       bool showHeader)
+{
+	beginResetModel();
+	_groups.push_back({name, model, showHeader});
+	_connectGroup(_groups.size() - 1);
+	endResetModel();
+}
+
+bool QuickAccessGroupedModel::isHeader(const QModelIndex &index)
+{
+	return index.isValid() && index.data(HeaderRole).toBool();
+}
+
+int QuickAccessGroupedModel::_headerRows(size_t group) const
+{
+	auto &g = _groups[group];
+	return g.showHeader && g.model->rowCount() > 0 ? 1 : 0;
+}
+
+int QuickAccessGroupedModel::_groupOffset(size_t group) const
+{
+	int offset = 0;
+	for (size_t i = 0; i < group && i < _groups.size(); i++) {
+		offset += _headerRows(i) + _groups[i].model->rowCount();
+	}
+	return offset;
+}
+
+bool QuickAccessGroupedModel::_locate(int row, size_t &group,
+				      int &groupRow) const
+{
+	// groupRow is -1 for a group's header row.
+	for (group = 0; group < _groups.size(); group++) {
+		int header = _headerRows(group);
+		int rows = header + _groups[group].model->rowCount();
+		if (row < rows) {
+			groupRow = row - header;
+			return true;
+		}
+		row -= rows;
+	}
+	return false;
+}
+
+QModelIndex QuickAccessGroupedModel::mapToGroup(const QModelIndex &index) const
+{
+	size_t group;
+	int groupRow;
+	if (!index.isValid() || !_locate(index.row(), group, groupRow) ||
+	    groupRow < 0) {
+		return QModelIndex();
+	}
+	return _groups[group].model->index(groupRow, 0);
+}
+
+QModelIndex
+QuickAccessGroupedModel::mapFromGroup(size_t group,
+				      const QModelIndex &groupIndex) const
+{
+	if (group >= _groups.size() || !groupIndex.isValid()) {
+		return QModelIndex();
+	}
+	return index(_groupOffset(group) + _headerRows(group) +
+		     groupIndex.row());
+}
+
+int QuickAccessGroupedModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid()) {
+		return 0;
+	}
+	return _groupOffset(_groups.size());
+}
+
+QVariant QuickAccessGroupedModel::data(const QModelIndex &index,
+				       int role) const
+{
+	size_t group;
+	int groupRow;
+	if (!index.isValid() || !_locate(index.row(), group, groupRow)) {
+		return {};
+	}
+	if (groupRow < 0) {
+		if (role == HeaderRole) {
+			return true;
+		} else if (role == Qt::DisplayRole) {
+			return QString::fromStdString(_groups[group].name);
+		}
+		return {};
+	}
+	if (role == HeaderRole) {
+		return false;
+	}
+	return _groups[group].model->index(groupRow, 0).data(role);
+}
+
+Qt::ItemFlags QuickAccessGroupedModel::flags(const QModelIndex &index) const
+{
+	size_t group;
+	int groupRow;
+	if (!index.isValid() || !_locate(index.row(), group, groupRow)) {
+		return Qt::NoItemFlags;
+	}
+	if (groupRow < 0) {
+		// Headers can't be selected or reached with the keyboard.
+		return Qt::NoItemFlags;
+	}
+	return _groups[group].model->index(groupRow, 0).flags();
+}
+
+void QuickAccessGroupedModel::_connectGroup(size_t group)
+{
+	auto model = _groups[group].model;
+
+	// Begin signals are emitted before the group model changes, so the
+	// offsets computed here still describe the current layout.  A
+	// group's header is inserted with its first row and removed with
+	// its last one.
+	connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this,
+		[this, group](const QModelIndex &, int first, int last) {
+			int offset = _groupOffset(group);
+			auto &g = _groups[group];
+			if (g.showHeader && g.model->rowCount() == 0) {
+				beginInsertRows(QModelIndex(), offset,
+						offset + 1 + last - first);
+				return;
+			}
+			int start = offset + _headerRows(group);
+			beginInsertRows(QModelIndex(), start + first,
+					start + last);
+		});
+	connect(model, &QAbstractItemModel::rowsInserted, this,
+		[this]() { endInsertRows(); });
+	connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+		[this, group](const QModelIndex &, int first, int last) {
+			int offset = _groupOffset(group);
+			int header = _headerRows(group);
+			auto &g = _groups[group];
+			if (header && last - first + 1 == g.model->rowCount()) {
+				beginRemoveRows(QModelIndex(), offset,
+						offset + header + last - first);
+				return;
+			}
+			beginRemoveRows(QModelIndex(), offset + header + first,
+					offset + header + last);
+		});
+	connect(model, &QAbstractItemModel::rowsRemoved, this,
+		[this]() { endRemoveRows(); });
+	connect(model, &QAbstractItemModel::dataChanged, this,
+		[this, group](const QModelIndex &topLeft,
+			      const QModelIndex &bottomRight,
+			      const QList<int> &roles) {
+			int start = _groupOffset(group) + _headerRows(group);
+			emit dataChanged(index(start + topLeft.row()),
+					 index(start + bottomRight.row()),
+					 roles);
+		});
+	connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this,
+		[this]() { _beginLayoutChange(); });
+	connect(model, &QAbstractItemModel::layoutChanged, this,
+		[this]() { _endLayoutChange(); });
+	connect(model, &QAbstractItemModel::modelAboutToBeReset, this,
+		[this]() { beginResetModel(); });
+	connect(model, &QAbstractItemModel::modelReset, this,
+		[this]() { endResetModel(); });
+}
+
+void QuickAccessGroupedModel::_beginLayoutChange()
+{
+	emit layoutAboutToBeChanged();
+	// Remember what every persistent index points at in terms of the
+	// group models, which keep their own persistent indexes up to date.
+	_layoutIndexes = persistentIndexList();
+	_layoutTargets.clear();
+	for (auto &idx : _layoutIndexes) {
+		size_t group;
+		int groupRow;
+		if (!_locate(idx.row(), group, groupRow)) {
+			_layoutTargets.push_back(
+				{_groups.size(), false, QModelIndex()});
+		} else if (groupRow < 0) {
+			_layoutTargets.push_back({group, true, QModelIndex()});
+		} else {
+			_layoutTargets.push_back(
+				{group, false,
+				 _groups[group].model->index(groupRow, 0)});
+		}
+	}
+}
+
+void QuickAccessGroupedModel::_endLayoutChange()
+{
+	QModelIndexList to;
+	for (auto &target : _layoutTargets) {
+		if (target.group >= _groups.size()) {
+			to.append(QModelIndex());
+		} else if (target.header) {
+			to.append(_headerRows(target.group)
+					  ? index(_groupOffset(target.group))
+					  : QModelIndex());
+		} else {
+			to.append(mapFromGroup(target.group, target.index));
+		}
+	}
+	changePersistentIndexList(_layoutIndexes, to);
+	_layoutIndexes.clear();
+	_layoutTargets.clear();
+	emit layoutChanged();
 }
 
 QuickAccessSource::QuickAccessSource(obs_source_t *source)
@@ -391,6 +961,10 @@ QuickAccessSource::~QuickAccessSource()
 	}
 	for (auto &child : _children) {
 		child->removeParent(this);
+		child->removeSceneItems(this);
+	}
+	for (auto &[parent, item] : _sceneItems) {
+		obs_sceneitem_release(item);
 	}
 
 	obs_weak_source_release(_source);
@@ -398,6 +972,7 @@ QuickAccessSource::~QuickAccessSource()
 
 void QuickAccessSource::itemAdded(void* data, calldata_t* params)
 {
+	QAU_TRACE_SCOPE("QuickAccessSource::itemAdded");
 	QuickAccessSource &instance = *static_cast<QuickAccessSource *>(data);
 
 	obs_sceneitem_t *sceneItem =
@@ -405,13 +980,18 @@ void QuickAccessSource::itemAdded(void* data, calldata_t* params)
 	obs_source_t *source = obs_sceneitem_get_source(sceneItem);
 	std::string sourceId = obs_source_get_uuid(source);
 	auto* child = qau->GetSource(sourceId);
+	if (!child) {
+		return;
+	}
 	instance.addChild(child);
 	child->addParent(&instance);
-	qau->UpdateSceneSources();
+	child->addSceneItem(&instance, sceneItem);
+	qau->UpdateSceneSources(&instance);
 }
 
 void QuickAccessSource::itemRemoved(void* data, calldata_t* params)
 {
+	QAU_TRACE_SCOPE("QuickAccessSource::itemRemoved");
 	QuickAccessSource &instance = *static_cast<QuickAccessSource *>(data);
 
 	obs_sceneitem_t *sceneItem =
@@ -419,9 +999,13 @@ void QuickAccessSource::itemRemoved(void* data, calldata_t* params)
 	obs_source_t *source = obs_sceneitem_get_source(sceneItem);
 	std::string sourceId = obs_source_get_uuid(source);
 	auto *child = qau->GetSource(sourceId);
+	if (!child) {
+		return;
+	}
 	child->removeParent(&instance);
+	child->removeSceneItem(sceneItem);
 	instance.removeChild(child);
-	qau->UpdateSceneSources();
+	qau->UpdateSceneSources(&instance);
 }
 
 void QuickAccessSource::_setCallbacks()
@@ -430,10 +1014,8 @@ void QuickAccessSource::_setCallbacks()
 
 	signal_handler_t *signalHandler =
 		obs_source_get_signal_handler(source);
-	if (_sourceClass != SourceClass::Scene) {
-		_itemAddSig.Connect(signalHandler, "item_add", QuickAccessSource::itemAdded, this);
-		_itemRemoveSig.Connect(signalHandler, "item_remove", QuickAccessSource::itemRemoved, this);
-	}
+	_itemAddSig.Connect(signalHandler, "item_add", QuickAccessSource::itemAdded, this);
+	_itemRemoveSig.Connect(signalHandler, "item_remove", QuickAccessSource::itemRemoved, this);
 	obs_source_release(source);
 }
 
@@ -477,6 +1059,29 @@ std::string QuickAccessSource::getName() const
 	return name;
 }
 
+bool QuickAccessSource::sortLess(const QuickAccessSource *a,
+				 const QuickAccessSource *b)
+{
+	// Sources that were never indexed sort first.
+	if (!a->_sortKey || !b->_sortKey) {
+		return !a->_sortKey && b->_sortKey;
+	}
+	return a->_sortKey->compare(*b->_sortKey) < 0;
+}
+
+QCollator &QuickAccessSource::collator()
+{
+	// QCollator isn't thread safe and sort keys are built on whichever
+	// thread libobs signals from, so each thread gets its own.
+	thread_local QCollator collator = []() {
+		QCollator c;
+		c.setCaseSensitivity(Qt::CaseInsensitive);
+		c.setNumericMode(true);
+		return c;
+	}();
+	return collator;
+}
+
 std::string QuickAccessSource::getUUID() const
 {
 	auto source = obs_weak_source_get_source(_source);
@@ -501,12 +1106,15 @@ bool QuickAccessSource::save(obs_data_t *itemObj)
 		return false;
 	}
 	std::string sourceName = getName();
+	std::string uuid = getUUID();
+	obs_data_set_string(itemObj, "source_uuid", uuid.c_str());
 	obs_data_set_string(itemObj, "source_name", sourceName.c_str());
 	return true;
 }
 
 std::vector<SearchType> QuickAccessSource::search(std::string searchTerm)
 {
+	QAU_TRACE_SCOPE("QuickAccessSource::search");
 	std::vector<SearchType> hits;
 	for (auto &st : SearchTypes) {
 		for (auto &haystack : _searchTerms[st]) {
@@ -526,7 +1134,14 @@ std::vector<SearchType> QuickAccessSource::search(std::string searchTerm)
 	return hits;
 }
 
-bool QuickAccessSource::hasMatch(std::string &searchTerm, SearchType st)
+bool QuickAccessSource::hasMatch(const std::string &searchTerm,
+				 SearchType st)
+{
+	return findMatch(searchTerm, st, nullptr);
+}
+
+bool QuickAccessSource::findMatch(const std::string &searchTerm,
+				  SearchType st, QuickAccessMatchSpan *span)
 {
 	for (auto &haystack : _searchTerms[st]) {
 		auto it = std::search(haystack.begin(), haystack.end(),
@@ -534,15 +1149,41 @@ bool QuickAccessSource::hasMatch(std::string &searchTerm, SearchType st)
 				      [](char a, char b) {
 					      return tolower(a) == tolower(b);
 				      });
-		if (it != haystack.end()) {
-			return true;
+		if (it == haystack.end()) {
+			continue;
 		}
+		if (span) {
+			// Done once per query so painting the span is free.
+			auto offset = static_cast<size_t>(it - haystack.begin());
+			auto end = offset + searchTerm.size();
+			QString before =
+				QString::fromUtf8(haystack.data(), offset);
+			QString matched = QString::fromUtf8(
+				haystack.data() + offset, searchTerm.size());
+			QString after = QString::fromUtf8(
+				haystack.data() + end, haystack.size() - end);
+			// Names are drawn in full with the match bold in
+			// place, so only other values are trimmed.
+			if (st != SearchType::Source &&
+			    before.size() > MATCH_CONTEXT_CHARS) {
+				before = QChar(0x2026) +
+					 before.right(MATCH_CONTEXT_CHARS);
+			}
+			span->searchType = st;
+			span->inName = st == SearchType::Source &&
+				       &haystack == &_searchTerms[st].front();
+			span->text = before + matched + after;
+			span->start = static_cast<int>(before.size());
+			span->length = static_cast<int>(matched.size());
+		}
+		return true;
 	}
 	return false;
 }
 
 void QuickAccessSource::BuildSearchTerms()
 {
+	QAU_TRACE_SCOPE("QuickAccessSource::BuildSearchTerms");
 	std::unique_lock lock(_m);
 	auto source = obs_weak_source_get_source(_source);
 	_searchTerms[SearchType::Source].clear();
@@ -552,11 +1193,14 @@ void QuickAccessSource::BuildSearchTerms()
 	_searchTerms[SearchType::File].clear();
 
 	if (!source) {
+		_capabilities = 0;
 		return;
 	}
 
 	// Source Name
-	_searchTerms[SearchType::Source].push_back(obs_source_get_name(source));
+	const char *name = obs_source_get_name(source);
+	_searchTerms[SearchType::Source].push_back(name);
+	QString sortName = QString::fromUtf8(name);
 	_searchTerms[SearchType::Source].push_back(obs_source_get_uuid(source));
 
 	// Source Type Id and Name
@@ -589,6 +1233,26 @@ void QuickAccessSource::BuildSearchTerms()
 	}
 
 	obs_data_t *data = obs_source_get_settings(source);
+
+	// Capabilities, so the UI doesn't have to ask libobs for them
+	uint8_t caps = 0;
+	if (obs_source_configurable(source)) {
+		caps |= CapProperties;
+	}
+	if (obs_source_get_output_flags(source) & OBS_SOURCE_INTERACTION) {
+		caps |= CapInteract;
+	}
+	if (strcmp(source_id, BROWSER_SOURCE_ID) == 0) {
+		caps |= CapRefresh;
+	}
+	if (strcmp(source_id, "dshow_input") == 0) {
+		caps |= CapActivation;
+		if (obs_data_get_bool(data, "active")) {
+			caps |= CapActive;
+		}
+	}
+	_capabilities = caps;
+
 	// Browser source urls
 	if (strcmp(source_id, BROWSER_SOURCE_ID) == 0) {
 		std::string url = obs_data_get_string(data, "url");
@@ -615,6 +1279,32 @@ void QuickAccessSource::BuildSearchTerms()
 	obs_data_release(data);
 
 	obs_source_release(source);
+	if (sortName == _sortName) {
+		// Settings updates don't change the name.
+		return;
+	}
+	_sortName = sortName;
+	lock.unlock();
+	_publishSortKey(collator().sortKey(sortName));
+}
+
+void QuickAccessSource::_publishSortKey(QCollatorSortKey key)
+{
+	// Sorted containers are only touched on the UI thread, so the key is
+	// only replaced there and never changes under a running sort.  A
+	// rename posts its dock updates after this, so they see the new key.
+	auto app = QCoreApplication::instance();
+	if (!app || QThread::currentThread() == app->thread()) {
+		_sortKey = std::move(key);
+		return;
+	}
+	// The source can be freed before this runs, a collection unload
+	// clears the registry on the UI thread, so it is looked up again.
+	QMetaObject::invokeMethod(app, [this, uuid = getUUID(), key]() {
+		if (qau && !uuid.empty() && qau->GetSource(uuid) == this) {
+			_sortKey = key;
+		}
+	});
 }
 
 void QuickAccessSource::update()
@@ -649,6 +1339,54 @@ void QuickAccessSource::removeParent(QuickAccessSource *parent)
 	}
 }
 
+void QuickAccessSource::addSceneItem(QuickAccessSource *parent,
+				     obs_sceneitem_t *item)
+{
+	std::unique_lock lock(_m);
+	obs_sceneitem_addref(item);
+	_sceneItems.push_back({parent, item});
+}
+
+void QuickAccessSource::removeSceneItem(obs_sceneitem_t *item)
+{
+	std::unique_lock lock(_m);
+	auto it = std::find_if(_sceneItems.begin(), _sceneItems.end(),
+			       [item](auto &entry) {
+				       return entry.second == item;
+			       });
+	if (it != _sceneItems.end()) {
+		obs_sceneitem_release(it->second);
+		_sceneItems.erase(it);
+	}
+}
+
+void QuickAccessSource::removeSceneItems(QuickAccessSource *parent)
+{
+	std::unique_lock lock(_m);
+	auto it = std::remove_if(_sceneItems.begin(), _sceneItems.end(),
+				 [parent](auto &entry) {
+					 if (entry.first != parent) {
+						 return false;
+					 }
+					 obs_sceneitem_release(entry.second);
+					 return true;
+				 });
+	_sceneItems.erase(it, _sceneItems.end());
+}
+
+std::vector<obs_sceneitem_t *> QuickAccessSource::sceneItems()
+{
+	// The caller owns a reference to each returned item.
+	std::unique_lock lock(_m);
+	std::vector<obs_sceneitem_t *> items;
+	items.reserve(_sceneItems.size());
+	for (auto &[parent, item] : _sceneItems) {
+		obs_sceneitem_addref(item);
+		items.push_back(item);
+	}
+	return items;
+}
+
 void QuickAccessSource::removeChild(QuickAccessSource *child)
 {
 	//std::unique_lock lock(_m);
@@ -720,30 +1458,6 @@ void QuickAccessSource::activateScene() const
 	obs_source_release(source);
 }
 
-bool QuickAccessSource::hasProperties() const
-{
-	obs_source_t *source = obs_weak_source_get_source(_source);
-	bool props = obs_source_configurable(source);
-	obs_source_release(source);
-	return props;
-}
-
-bool QuickAccessSource::hasInteract() const
-{
-	obs_source_t *source = obs_weak_source_get_source(_source);
-	uint32_t flags = obs_source_get_output_flags(source);
-	obs_source_release(source);
-	return (flags & OBS_SOURCE_INTERACTION) == OBS_SOURCE_INTERACTION;
-}
-
-bool QuickAccessSource::hasRefresh() const
-{
-	obs_source_t *source = obs_weak_source_get_source(_source);
-	std::string sourceType = obs_source_get_id(source);
-	obs_source_release(source);
-	return sourceType == "browser_source";
-}
-
 void QuickAccessSource::refreshBrowser() const
 {
 	obs_source_t *source = obs_weak_source_get_source(_source);
@@ -756,21 +1470,15 @@ void QuickAccessSource::refreshBrowser() const
 
 std::string QuickAccessSource::activeState() const
 {
-	obs_source_t *source = obs_weak_source_get_source(_source);
-	std::string type_str = obs_source_get_id(source);
-	std::string ret = "";
-	if (type_str == "dshow_input") {
-		auto settings = obs_source_get_settings(source);
-		bool now_active = obs_data_get_bool(settings, "active");
-		ret = now_active ? "Deactivate" : "Activate";
-		obs_data_release(settings);
+	uint8_t caps = _capabilities;
+	if (!(caps & CapActivation)) {
+		return "";
 	}
 	// macos-avcapture-fast and av_capture_input on macos
-	obs_source_release(source);
-	return ret;
+	return (caps & CapActive) ? "Deactivate" : "Activate";
 }
 
-void QuickAccessSource::toggleActivation() const
+void QuickAccessSource::toggleActivation()
 {
 	obs_source_t *source = obs_weak_source_get_source(_source);
 	if (!source) {
@@ -787,6 +1495,12 @@ void QuickAccessSource::toggleActivation() const
 	proc_handler_t *ph = obs_source_get_proc_handler(source);
 	proc_handler_call(ph, "activate", &cd);
 	calldata_free(&cd);
+
+	if (nowActive) {
+		_capabilities &= static_cast<uint8_t>(~CapActive);
+	} else {
+		_capabilities |= CapActive;
+	}
 }
 
 QDataStream &operator<<(QDataStream &out, QuickAccessSource *const &rhs)
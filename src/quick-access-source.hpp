@@ -6,23 +6,76 @@
 #include <map>
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <mutex>
+#include <atomic>
+#include <optional>
+#include <memory>
 #include <thread>
 #include <QObject>
 #include <QVariant>
 #include <QAbstractListModel>
+#include <QSortFilterProxyModel>
 #include <QStyledItemDelegate>
 #include <QPainter>
 #include <QMetaType>
 #include <QDataStream>
+#include <QCollator>
 
 class QuickAccessDock;
 class QuickAccessSource;
+struct QuickAccessSearchResult;
 
 enum class SearchType { None, Source, Type, Filters, Url, File };
 
 enum class SourceClass { Source, Scene, Group };
 
+enum class SourceButton { None, ParentScenes, Filters, Properties };
+
+// Where a search term matched.  text is the matched value, cut down to the
+// part around the match, start and length are in QString units.
+struct QuickAccessMatchSpan {
+	SearchType searchType = SearchType::None;
+	QString text;
+	int start = 0;
+	int length = 0;
+	// A Source match can be in the name or the UUID.
+	bool inName = false;
+};
+
+struct QuickAccessSearchHit {
+	uint32_t types = 0;
+	std::vector<QuickAccessMatchSpan> spans;
+};
+
+// Result of one query, shared by all consumers.  A source is matched the
+// first time any consumer asks about it, so consumers that publish their
+// rows a chunk at a time only pay for what they have shown.
+struct QuickAccessSearchResult {
+	std::string searchTerm;
+	uint64_t generation = 0;
+	const QuickAccessSearchHit &hit(QuickAccessSource *source) const;
+	void evaluate(const std::vector<QuickAccessSource *> &sources) const;
+	bool hasMatch(QuickAccessSource *source, SearchType st) const;
+	const QuickAccessMatchSpan *span(QuickAccessSource *source,
+					 SearchType st) const;
+	// Best count matches among the sources evaluated so far.
+	std::vector<QuickAccessSource *> top(size_t count) const;
+
+private:
+	mutable std::unordered_map<QuickAccessSource *, QuickAccessSearchHit>
+		_hits;
+};
+
+// Source capabilities, captured in QuickAccessSource::BuildSearchTerms.
+enum SourceCapability : uint8_t {
+	CapProperties = 1 << 0,
+	CapInteract = 1 << 1,
+	CapRefresh = 1 << 2,
+	CapActivation = 1 << 3,
+	CapActive = 1 << 4,
+};
+
 class QuickAccessSourceDelegate : public QStyledItemDelegate {
 	Q_OBJECT
 public:
@@ -40,6 +93,15 @@ public:
 			 const QStyleOptionViewItem &option,
 			 const QModelIndex &index);
 
+	SourceButton buttonAt(const QModelIndex &index, const QRect &rect,
+			      const QPoint &pos) const;
+	void drawMatch(QPainter *painter, QRect rect, const QString &name,
+		       const QuickAccessMatchSpan &span,
+		       const QFont &font) const;
+	bool setHover(const QModelIndex &index, SourceButton button);
+	inline QModelIndex hoverIndex() const { return _hoverIndex; }
+	inline QModelIndex pressedIndex() const { return _pressedIndex; }
+
 signals:
 	void openPropertiesClicked(const QModelIndex &index);
 	void openParentScenesClicked(const QModelIndex &index);
@@ -48,9 +110,13 @@ signals:
 	void itemSelected(const QModelIndex &index);
 
 private:
-	QStyle::State _propertiesState;
-	QStyle::State _filtersState;
-	QStyle::State _parentScenesState;
+	QStyle::State _buttonState(const QModelIndex &index,
+				   SourceButton button) const;
+
+	QPersistentModelIndex _hoverIndex;
+	SourceButton _hoverButton = SourceButton::None;
+	QPersistentModelIndex _pressedIndex;
+	SourceButton _pressedButton = SourceButton::None;
 	QuickAccessDock *_dock;
 };
 
@@ -58,17 +124,21 @@ class QuickAccessSourceModel : public QAbstractListModel {
 	Q_OBJECT
 
 public:
-	explicit QuickAccessSourceModel(
-		QObject *parent = nullptr,
-		SearchType searchType = SearchType::None);
+	explicit QuickAccessSourceModel(QObject *parent = nullptr);
 	inline void setSources(std::vector<QuickAccessSource *> *newData)
 	{
 		_data = newData;
 	}
-	void addSource(QuickAccessSource *source);
+	inline void setSorted(bool sorted) { _sorted = sorted; }
+	inline bool sorted() const { return _sorted; }
+	void addSource(QuickAccessSource *source, int row = -1);
+	void addSources(const std::vector<QuickAccessSource *> &sources,
+			int row = -1);
 	void removeSource(QuickAccessSource *source);
-	void setSearchTerm(std::string searchTerm);
+	void resetSources(std::vector<QuickAccessSource *> sources);
+	void sourceChanged(QuickAccessSource *source);
 	QuickAccessSource *item(int row) const;
+	static QuickAccessSource *sourceAt(const QModelIndex &index);
 
 	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
 	QVariant data(const QModelIndex &index,
@@ -78,15 +148,94 @@ public:
 		     int role = Qt::DisplayRole) override;
 	bool insertRows(int row, int count, const QModelIndex &parent) override;
 	bool removeRows(int row, int count, const QModelIndex &parent) override;
-
-	void swapRows(int rowA, int rowB);
+	bool moveRows(const QModelIndex &sourceParent, int sourceRow, int count,
+		      const QModelIndex &destinationParent,
+		      int destinationChild) override;
 
 	Qt::DropActions supportedDropActions() const override;
 	Qt::ItemFlags flags(const QModelIndex &index) const override;
 
 private:
 	std::vector<QuickAccessSource *> *_data;
+	bool _sorted = false;
+};
+
+class QuickAccessSourceFilterModel : public QSortFilterProxyModel {
+	Q_OBJECT
+
+public:
+	enum { MatchRole = Qt::UserRole + 2 };
+
+	explicit QuickAccessSourceFilterModel(
+		QObject *parent = nullptr,
+		SearchType searchType = SearchType::None);
+	void setSearchTerm(std::string searchTerm);
+	QVariant data(const QModelIndex &index,
+		      int role = Qt::DisplayRole) const override;
+	inline SearchType searchType() const { return _searchType; }
+	// Whether an empty search term matches every row.
+	inline void setMatchEmpty(bool matchEmpty) { _matchEmpty = matchEmpty; }
+	// Whether only the display name is matched, leaving out the other
+	// terms of the search type (such as the source UUID).
+	inline void setNameOnly(bool nameOnly) { _nameOnly = nameOnly; }
+
+protected:
+	bool filterAcceptsRow(int sourceRow,
+			      const QModelIndex &sourceParent) const override;
+
+private:
 	SearchType _searchType;
+	std::string _searchTerm;
+	bool _matchEmpty = true;
+	bool _nameOnly = false;
+	// Shared with every other consumer of the same query.
+	mutable std::shared_ptr<const QuickAccessSearchResult> _results;
+};
+
+// Flattens several group models into one list for a single view.  Each
+// non-empty group is preceded by an inline header row, so the whole dock
+// can be drawn by one virtualized QListView.
+class QuickAccessGroupedModel : public QAbstractListModel {
+	Q_OBJECT
+
+public:
+	enum { HeaderRole = Qt::UserRole + 1 };
+
+	explicit QuickAccessGroupedModel(QObject *parent = nullptr);
+	void addGroup(std::string name, QAbstractItemModel *model,
+		      bool showHeader);
+	QModelIndex mapToGroup(const QModelIndex &index) const;
+	QModelIndex mapFromGroup(size_t group,
+				 const QModelIndex &groupIndex) const;
+	static bool isHeader(const QModelIndex &index);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index,
+		      int role = Qt::DisplayRole) const override;
+	Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+	struct Group {
+		std::string name;
+		QAbstractItemModel *model;
+		bool showHeader;
+	};
+	struct LayoutTarget {
+		size_t group;
+		bool header;
+		QPersistentModelIndex index;
+	};
+
+	int _headerRows(size_t group) const;
+	int _groupOffset(size_t group) const;
+	bool _locate(int row, size_t &group, int &groupRow) const;
+	void _connectGroup(size_t group);
+	void _beginLayoutChange();
+	void _endLayoutChange();
+
+	std::vector<Group> _groups;
+	QModelIndexList _layoutIndexes;
+	std::vector<LayoutTarget> _layoutTargets;
 };
 
 typedef std::map<SearchType, std::vector<std::string>> SearchTermMap;
@@ -100,9 +249,16 @@ public:
 
 	std::string getName() const;
 	std::string getUUID() const;
+	static bool sortLess(const QuickAccessSource *a,
+			     const QuickAccessSource *b);
+	static QCollator &collator();
 	obs_source_t *get();
 	void addDock(QuickAccessDock *);
 	void removeDock(QuickAccessDock *);
+	inline const std::set<QuickAccessDock *> &docks() const
+	{
+		return _docks;
+	}
 	inline bool removing() { return _removing; }
 	inline void addParent(QuickAccessSource *parent)
 	{
@@ -115,12 +271,18 @@ public:
 	inline void markForRemoval() { _removing = true; }
 	void removeParent(QuickAccessSource *parent);
 	void removeChild(QuickAccessSource *child);
+	void addSceneItem(QuickAccessSource *parent, obs_sceneitem_t *item);
+	void removeSceneItem(obs_sceneitem_t *item);
+	void removeSceneItems(QuickAccessSource *parent);
+	std::vector<obs_sceneitem_t *> sceneItems();
 	signal_handler_t *getSignalHandler();
 	inline std::vector<QuickAccessSource *> children() { return _children; }
 	inline std::vector<QuickAccessSource *> parents() { return _parents; }
 	inline SourceClass sourceType() { return _sourceClass; }
 	std::vector<SearchType> search(std::string searchTerm);
-	bool hasMatch(std::string &searchTerm, SearchType st);
+	bool hasMatch(const std::string &searchTerm, SearchType st);
+	bool findMatch(const std::string &searchTerm, SearchType st,
+		       QuickAccessMatchSpan *span);
 	void update();
 	void openProperties() const;
 	void openFilters() const;
@@ -128,11 +290,14 @@ public:
 	void openWindowedProjector() const;
 	void openFullScreenProjector(int id) const;
 	void refreshBrowser() const;
-	void toggleActivation() const;
+	void toggleActivation();
 	void activateScene() const;
-	bool hasProperties() const;
-	bool hasInteract() const;
-	bool hasRefresh() const;
+	inline bool hasProperties() const
+	{
+		return _capabilities & CapProperties;
+	}
+	inline bool hasInteract() const { return _capabilities & CapInteract; }
+	inline bool hasRefresh() const { return _capabilities & CapRefresh; }
 	static void itemAdded(void *data, calldata_t *params);
 	static void itemRemoved(void *data, calldata_t *params);
 	std::string activeState() const;
@@ -147,12 +312,22 @@ public:
 
 private:
 	void _setCallbacks();
+	void _publishSortKey(QCollatorSortKey key);
 	obs_weak_source_t *_source;
 	SourceClass _sourceClass;
 	SearchTermMap _searchTerms;
+	// Only assigned on the UI thread, see _publishSortKey.
+	std::optional<QCollatorSortKey> _sortKey;
+	// Name _sortKey was last built from, guarded by _m.
+	QString _sortName;
+	std::atomic<uint8_t> _capabilities{0};
 	bool _removing = false;
 	std::vector<QuickAccessSource *> _parents;
 	std::vector<QuickAccessSource *> _children;
+	// Scene items (with a reference) that show this source, along with
+	// the scene or group that owns them.
+	std::vector<std::pair<QuickAccessSource *, obs_sceneitem_t *>>
+		_sceneItems;
 	std::set<QuickAccessDock *> _docks;
 	std::mutex _m;
 	// TODO: Get rid of _tmpName
@@ -164,6 +339,7 @@ private:
 };
 
 Q_DECLARE_METATYPE(QuickAccessSource *)
+Q_DECLARE_METATYPE(QuickAccessMatchSpan)
 
 QDataStream &operator<<(QDataStream &out, QuickAccessSource *const &rhs);
 QDataStream &operator>>(QDataStream &in, QuickAccessSource *&rhs);
@@ -0,0 +1,136 @@
+#include "quick-access-trace.hpp"
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "version.h"
+
+// Events kept per thread, older ones are overwritten.
+#define TRACE_RING_SIZE 16384
+
+namespace {
+
+struct TraceEvent {
+	// Odd while the slot is being written.
+	std::atomic<uint64_t> seq{0};
+	const char *name = nullptr;
+	uint64_t start = 0;
+	uint64_t duration = 0;
+};
+
+// Only its own thread writes to a ring, so recording needs no lock.  The
+// ring stays registered after the thread exits so its events can still be
+// written out.
+struct TraceRing {
+	uint32_t tid = 0;
+	std::atomic<uint64_t> head{0};
+	std::array<TraceEvent, TRACE_RING_SIZE> events;
+};
+
+std::mutex ringsMutex;
+std::vector<std::shared_ptr<TraceRing>> rings;
+
+TraceRing *threadRing()
+{
+	thread_local std::shared_ptr<TraceRing> ring;
+	if (!ring) {
+		ring = std::make_shared<TraceRing>();
+		std::unique_lock lock(ringsMutex);
+		ring->tid = static_cast<uint32_t>(rings.size() + 1);
+		rings.push_back(ring);
+	}
+	return ring.get();
+}
+
+void appendEscaped(std::string &out, const char *str)
+{
+	for (; *str; str++) {
+		if (*str == '"' || *str == '\\') {
+			out += '\\';
+		}
+		out += *str;
+	}
+}
+
+} // namespace
+
+QuickAccessTraceScope::QuickAccessTraceScope(const char *name)
+	: _name(name),
+	  _start(os_gettime_ns())
+{
+}
+
+QuickAccessTraceScope::~QuickAccessTraceScope()
+{
+	uint64_t end = os_gettime_ns();
+	auto ring = threadRing();
+	uint64_t idx = ring->head.load(std::memory_order_relaxed);
+	auto &event = ring->events[idx % TRACE_RING_SIZE];
+	event.seq.store(idx * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	event.name = _name;
+	event.start = _start;
+	event.duration = end - _start;
+	event.seq.store(idx * 2 + 2, std::memory_order_release);
+	ring->head.store(idx + 1, std::memory_order_release);
+}
+
+bool QuickAccessTraceWrite(const std::string &path)
+{
+	std::vector<std::shared_ptr<TraceRing>> snapshot;
+	{
+		std::unique_lock lock(ringsMutex);
+		snapshot = rings;
+	}
+
+	std::string json = "{\"traceEvents\":[";
+	bool first = true;
+	for (auto &ring : snapshot) {
+		uint64_t head = ring->head.load(std::memory_order_acquire);
+		uint64_t begin = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE
+							: 0;
+		for (uint64_t idx = begin; idx < head; idx++) {
+			auto &event = ring->events[idx % TRACE_RING_SIZE];
+			uint64_t seq = event.seq.load(std::memory_order_acquire);
+			const char *name = event.name;
+			uint64_t start = event.start;
+			uint64_t duration = event.duration;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			// Skip slots the thread overwrote while we read them.
+			if (seq != idx * 2 + 2 ||
+			    event.seq.load(std::memory_order_relaxed) != seq ||
+			    !name) {
+				continue;
+			}
+			json += first ? "\n" : ",\n";
+			first = false;
+			json += "{\"name\":\"";
+			appendEscaped(json, name);
+			json += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+			json += std::to_string(ring->tid);
+			json += ",\"ts\":";
+			json += std::to_string(start / 1000);
+			json += ".";
+			json += std::to_string(start % 1000 / 100);
+			json += ",\"dur\":";
+			json += std::to_string(duration / 1000);
+			json += ".";
+			json += std::to_string(duration % 1000 / 100);
+			json += "}";
+		}
+	}
+	json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	if (!os_quick_write_utf8_file(path.c_str(), json.c_str(), json.size(),
+				      false)) {
+		blog(LOG_WARNING, "Failed to write trace to %s", path.c_str());
+		return false;
+	}
+	blog(LOG_INFO, "Wrote trace to %s", path.c_str());
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Scoped timers for the plugin's hot paths.  Only compiled in when the
+// plugin is built with ENABLE_TRACING, otherwise QAU_TRACE_SCOPE expands to
+// nothing.  Name must be a string literal, only the pointer is recorded.
+#ifdef QAU_TRACING
+#define QAU_TRACE_CONCAT_(a, b) a##b
+#define QAU_TRACE_CONCAT(a, b) QAU_TRACE_CONCAT_(a, b)
+#define QAU_TRACE_SCOPE(name) \
+	QuickAccessTraceScope QAU_TRACE_CONCAT(_traceScope, __LINE__)(name)
+#else
+#define QAU_TRACE_SCOPE(name)
+#endif
+
+class QuickAccessTraceScope {
+public:
+	explicit QuickAccessTraceScope(const char *name);
+	~QuickAccessTraceScope();
+
+private:
+	const char *_name;
+	uint64_t _start;
+};
+
+// Writes every buffered event as a Chrome trace (chrome://tracing or
+// Perfetto) JSON file.
+bool QuickAccessTraceWrite(const std::string &path);
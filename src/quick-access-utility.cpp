@@ -1,6 +1,7 @@
 #include "quick-access-utility.hpp"
 #include "quick-access-dock.hpp"
 #include "quick-access.hpp"
+#include "quick-access-trace.hpp"
 
 #include <util/platform.h>
 #include <QMainWindow>
@@ -10,18 +11,33 @@
 #include <QThread>
 #include <QMetaObject>
 #include <QPushButton>
+#include <QTimer>
+#include <QDateTime>
+#include <QScreen>
+#include <QGuiApplication>
+
+#include <algorithm>
+#include <functional>
 
 #include "version.h"
 
 #define QT_UTF8(str) QString::fromUtf8(str)
 #define QT_TO_UTF8(str) str.toUtf8().constData()
 
+#define SCENE_CLOSURE_CACHE_SIZE 8
+#define PREWARM_HISTORY_COUNT 2
+// Prewarming waits this long after a scene switch, so it doesn't compete
+// with the switch itself for the UI thread.
+#define PREWARM_DELAY_MS 250
+#define SEARCH_CACHE_SIZE 16
+
 QuickAccessUtility *qau = nullptr;
 QuickAccessUtilityDialog *qauDialog = nullptr;
 QuickAccessSearchModal *qauSearch = nullptr;
 
 QuickAccessUtilityDialog *QuickAccessUtilityDialog::dialog = nullptr;
 QuickAccessSearchModal *QuickAccessSearchModal::dialog = nullptr;
+uint64_t QuickAccessSearchModal::_openStart = 0;
 
 QuickAccessUtility::QuickAccessUtility(obs_module_t *m)
 	: _module(m),
@@ -35,6 +51,8 @@ QuickAccessUtility::QuickAccessUtility(obs_module_t *m)
 	_quick_search_hotkey_id = obs_hotkey_register_frontend(
 		"Quick Search", "Opens Quick Search",
 		QuickAccessSearchModal::OpenQuickSearch, this);
+
+	_repaintScheduler = new QuickAccessRepaintScheduler();
 }
 
 QuickAccessUtility::~QuickAccessUtility()
@@ -44,10 +62,71 @@ QuickAccessUtility::~QuickAccessUtility()
 	obs_frontend_remove_event_callback(QuickAccessUtility::FrontendCallback,
 					   this);
 	obs_hotkey_unregister(_quick_search_hotkey_id);
+	delete _repaintScheduler;
+}
+
+void QuickAccessUtility::ScheduleRepaint(QWidget *widget)
+{
+	if (_repaintScheduler) {
+		_repaintScheduler->Schedule(widget);
+	}
+}
+
+QuickAccessRepaintScheduler::QuickAccessRepaintScheduler(QObject *parent)
+	: QObject(parent)
+{
+	_timer.setSingleShot(true);
+	_timer.setTimerType(Qt::PreciseTimer);
+	connect(&_timer, &QTimer::timeout, this,
+		&QuickAccessRepaintScheduler::_Flush);
+}
+
+void QuickAccessRepaintScheduler::Schedule(QWidget *widget)
+{
+	if (!widget) {
+		return;
+	}
+	if (std::find(_pending.begin(), _pending.end(), widget) ==
+	    _pending.end()) {
+		_pending.emplace_back(widget);
+	}
+	if (_timer.isActive()) {
+		return;
+	}
+	// Flush right away if the last flush was a frame ago, otherwise
+	// wait for the rest of the frame.
+	int interval = _FrameInterval();
+	qint64 elapsed = _sinceFlush.isValid() ? _sinceFlush.elapsed()
+					       : interval;
+	_timer.start(static_cast<int>(
+		std::max<qint64>(0, interval - elapsed)));
+}
+
+void QuickAccessRepaintScheduler::_Flush()
+{
+	_sinceFlush.start();
+	auto pending = std::move(_pending);
+	_pending.clear();
+	for (auto &widget : pending) {
+		if (widget) {
+			widget->update();
+		}
+	}
+}
+
+int QuickAccessRepaintScheduler::_FrameInterval() const
+{
+	auto screen = QGuiApplication::primaryScreen();
+	qreal rate = screen ? screen->refreshRate() : 0.0;
+	if (rate < 1.0) {
+		rate = 60.0;
+	}
+	return std::max(1, static_cast<int>(1000.0 / rate));
 }
 
 void QuickAccessUtility::SourceCreated(void *data, calldata_t *params)
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::SourceCreated");
 	if (!qau->loaded) {
 		return;
 	}
@@ -62,6 +141,7 @@ void QuickAccessUtility::SourceCreated(void *data, calldata_t *params)
 	if (qau->_allSources.count(uuid) == 0) {
 		return;
 	}
+	qau->InvalidateSearch();
 	QuickAccessSource *qaSource = qau->_allSources[uuid].get();
 	QMetaObject::invokeMethod(
 		QCoreApplication::instance()->thread(), [qaSource]() {
@@ -70,12 +150,16 @@ void QuickAccessUtility::SourceCreated(void *data, calldata_t *params)
 					dock->SourceCreated(qaSource);
 				}
 			}
-			QuickAccessSearchModal::dialog->SourceCreated(qaSource);
+			if (QuickAccessSearchModal::dialog) {
+				QuickAccessSearchModal::dialog->SourceCreated(
+					qaSource);
+			}
 		});
 }
 
 void QuickAccessUtility::SourceDestroyed(void *data, calldata_t *params)
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::SourceDestroyed");
 	UNUSED_PARAMETER(data);
 	obs_source_t *source =
 		static_cast<obs_source_t *>(calldata_ptr(params, "source"));
@@ -93,10 +177,14 @@ void QuickAccessUtility::SourceDestroyed(void *data, calldata_t *params)
 						dock->SourceDestroyed(qaSource);
 					}
 				}
-				QuickAccessSearchModal::dialog->SourceDestroyed(
-					qaSource);
+				if (QuickAccessSearchModal::dialog) {
+					QuickAccessSearchModal::dialog
+						->SourceDestroyed(qaSource);
+				}
 				it->second->markForRemoval();
+				qau->InvalidateSceneClosures();
 				qau->_allSources.erase(it);
+				qau->InvalidateSearch();
 			});
 	}
 	lock.unlock();
@@ -105,6 +193,7 @@ void QuickAccessUtility::SourceDestroyed(void *data, calldata_t *params)
 
 void QuickAccessUtility::SourceUpdate(void *data, calldata_t *params)
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::SourceUpdate");
 	UNUSED_PARAMETER(data);
 	UNUSED_PARAMETER(params);
 
@@ -115,10 +204,12 @@ void QuickAccessUtility::SourceUpdate(void *data, calldata_t *params)
 		return;
 	}
 	qau->_allSources[uuid]->update();
+	qau->InvalidateSearch();
 }
 
 void QuickAccessUtility::SourceRename(void *data, calldata_t *params)
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::SourceRename");
 	UNUSED_PARAMETER(data);
 	if (!qau->loaded) {
 		return;
@@ -131,12 +222,20 @@ void QuickAccessUtility::SourceRename(void *data, calldata_t *params)
 	}
 	QuickAccessSource *qaSource = qau->_allSources[uuid].get();
 	qaSource->update();
+	qau->InvalidateSearch();
 	QMetaObject::invokeMethod(
-		QCoreApplication::instance()->thread(), [qaSource]() {
-			for (auto &dock : qau->_docks) {
-				if (dock) {
-					dock->SourceRename(qaSource);
-				}
+		QCoreApplication::instance()->thread(), [uuid]() {
+			auto qaSource = qau->GetSource(uuid);
+			if (!qaSource) {
+				return;
+			}
+			// Cached closures are sorted by name, and the new sort
+			// key is only published on this thread.
+			qau->InvalidateSceneClosures();
+			// Copied, the dock may drop the source while updating.
+			auto docks = qaSource->docks();
+			for (auto &dock : docks) {
+				dock->SourceRename(qaSource);
 			}
 		});
 }
@@ -148,10 +247,14 @@ obs_module_t *QuickAccessUtility::GetModule()
 
 void QuickAccessUtility::UnloadDocks()
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::UnloadDocks");
 	std::unique_lock lock(qau->_m);
 	//delete _currentScene;
 	qau->_currentScene = nullptr;
 	qau->RemoveDocks();
+	qau->InvalidateSceneClosures();
+	qau->_sceneHistory.clear();
+	qau->_lastSceneId.clear();
 	qau->_allSources.clear();
 }
 
@@ -197,6 +300,7 @@ void QuickAccessUtility::Load(obs_data_t *data)
 
 void QuickAccessUtility::_SetupDocks()
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::_SetupDocks");
 	//std::unique_lock lock(_m);
 
 	// Add Scenes and sources to _allSources
@@ -217,20 +321,8 @@ void QuickAccessUtility::_SetupDocks()
 	}
 	obs_data_array_release(_dockSettings);
 
-	// Set up the quick search dialog
-	// This shouldn't need to be done, but for some reason
-	// the first time we pop open the search, it is a tiny
-	// window and then disappears.
-	if (!QuickAccessSearchModal::dialog) {
-		const QRect &hostRect = mainWindow->geometry();
-
-		QuickAccessSearchModal::dialog =
-			new QuickAccessSearchModal(mainWindow);
-		auto searchDlg = QuickAccessSearchModal::dialog;
-		searchDlg->open();
-		searchDlg->move(hostRect.center() - searchDlg->rect().center());
-		searchDlg->adjustSize();
-	}
+	// The quick search dialog is built once loading has finished, see
+	// QuickAccessSearchModal::Prewarm.
 
 	loaded = true;
 }
@@ -253,15 +345,6 @@ void QuickAccessUtility::Save(obs_data_t *data)
 	obs_data_array_release(dockArray);
 	obs_data_array_release(quickSearchHotkey);
 	obs_data_release(saveData);
-
-	QMetaObject::invokeMethod(QCoreApplication::instance()->thread(),
-				  [this]() {
-					  for (auto &dock : _docks) {
-						  if (dock) {
-							  dock->SourceUpdate();
-						  }
-					  }
-				  });
 }
 
 void QuickAccessUtility::RemoveDocks()
@@ -292,24 +375,159 @@ void QuickAccessUtility::_SetCurrentSceneSources()
 {
 	_currentSceneSources.clear();
 	if (_currentScene) {
-		_AddChildren(_currentScene);
+		_currentSceneSources = _GetSceneClosure(_currentScene);
 	}
 }
 
-void QuickAccessUtility::_AddChildren(QuickAccessSource *scene)
+std::vector<QuickAccessSource *>
+QuickAccessUtility::_GetSceneClosure(QuickAccessSource *scene)
+{
+	std::unique_lock lock(_closureMutex);
+	std::string uuid = scene->getUUID();
+	for (auto it = _sceneClosures.begin(); it != _sceneClosures.end();
+	     ++it) {
+		if (it->first == uuid) {
+			_sceneClosures.splice(_sceneClosures.begin(),
+					      _sceneClosures, it);
+			return it->second;
+		}
+	}
+
+	std::vector<QuickAccessSource *> closure;
+	std::unordered_set<QuickAccessSource *> seen;
+	_AddChildren(scene, closure, seen);
+	std::sort(closure.begin(), closure.end(), QuickAccessSource::sortLess);
+	_sceneClosures.emplace_front(uuid, closure);
+	if (_sceneClosures.size() > SCENE_CLOSURE_CACHE_SIZE) {
+		_sceneClosures.pop_back();
+	}
+	return closure;
+}
+
+std::shared_ptr<const QuickAccessSearchResult>
+QuickAccessUtility::Search(const std::string &searchTerm)
+{
+	QAU_TRACE_SCOPE("QuickAccessUtility::Search");
+	// Matching is case insensitive, so is the cache.
+	std::string key = searchTerm;
+	std::transform(key.begin(), key.end(), key.begin(),
+		       [](unsigned char c) { return (char)tolower(c); });
+
+	std::unique_lock lock(_searchMutex);
+	uint64_t generation = _searchGeneration;
+	if (!_searchResults.empty() &&
+	    _searchResults.front().second->generation != generation) {
+		_searchResults.clear();
+	}
+	for (auto it = _searchResults.begin(); it != _searchResults.end();
+	     ++it) {
+		if (it->first == key) {
+			_searchResults.splice(_searchResults.begin(),
+					      _searchResults, it);
+			return it->second;
+		}
+	}
+
+	// Sources are matched as consumers ask about them.
+	auto result = std::make_shared<QuickAccessSearchResult>();
+	result->searchTerm = searchTerm;
+	result->generation = generation;
+	_searchResults.emplace_front(key, result);
+	if (_searchResults.size() > SEARCH_CACHE_SIZE) {
+		_searchResults.pop_back();
+	}
+	return result;
+}
+
+void QuickAccessUtility::InvalidateSceneClosures(QuickAccessSource *scene)
+{
+	std::unique_lock lock(_closureMutex);
+	if (!scene) {
+		_sceneClosures.clear();
+		return;
+	}
+	// Only the scene's own closure and those of the scenes it is nested
+	// in can change.
+	std::string uuid = scene->getUUID();
+	_sceneClosures.remove_if([&uuid, scene](const auto &entry) {
+		return entry.first == uuid ||
+		       std::find(entry.second.begin(), entry.second.end(),
+				 scene) != entry.second.end();
+	});
+}
+
+void QuickAccessUtility::_AddChildren(
+	QuickAccessSource *scene, std::vector<QuickAccessSource *> &closure,
+	std::unordered_set<QuickAccessSource *> &seen)
 {
 	for (auto child : scene->children()) {
-		if (std::find(_currentSceneSources.begin(),
-			      _currentSceneSources.end(),
-			      child) == _currentSceneSources.end()) {
-			_currentSceneSources.push_back(child);
+		if (seen.insert(child).second) {
+			closure.push_back(child);
 			if (child->sourceType() != SourceClass::Source) {
-				_AddChildren(child);
+				_AddChildren(child, closure, seen);
 			}
 		}
 	}
 }
 
+void QuickAccessUtility::_SchedulePrewarm()
+{
+	if (_prewarmPending) {
+		return;
+	}
+	_prewarmPending = true;
+	QTimer::singleShot(PREWARM_DELAY_MS, QCoreApplication::instance(),
+			   []() {
+				   if (qau) {
+					   qau->_PrewarmSceneClosures();
+				   }
+			   });
+}
+
+void QuickAccessUtility::_PrewarmSceneClosures()
+{
+	_prewarmPending = false;
+	if (_sceneCollectionChanging) {
+		return;
+	}
+
+	std::vector<std::string> uuids;
+	if (obs_frontend_preview_program_mode_active()) {
+		obs_source_t *preview = obs_frontend_get_current_preview_scene();
+		if (preview) {
+			uuids.push_back(obs_source_get_uuid(preview));
+			obs_source_release(preview);
+		}
+	}
+
+	// Scenes most often switched to from the current one.
+	if (auto it = _sceneHistory.find(_lastSceneId);
+	    it != _sceneHistory.end()) {
+		std::vector<std::pair<int, std::string>> next;
+		for (auto &[uuid, count] : it->second) {
+			next.push_back({count, uuid});
+		}
+		size_t count = std::min<size_t>(next.size(),
+						PREWARM_HISTORY_COUNT);
+		std::partial_sort(next.begin(), next.begin() + count,
+				  next.end(), std::greater<>());
+		for (size_t i = 0; i < count; i++) {
+			uuids.push_back(next[i].second);
+		}
+	}
+
+	for (auto &uuid : uuids) {
+		auto it = _allSources.find(uuid);
+		if (it != _allSources.end() && it->second) {
+			_GetSceneClosure(it->second.get());
+		}
+	}
+	// Keep the current scene from being the next one evicted.
+	if (_currentScene) {
+		_GetSceneClosure(_currentScene);
+	}
+}
+
 void QuickAccessUtility::_SetupSignals()
 {
 	signal_handler_t *signalHandler = obs_get_signal_handler();
@@ -340,12 +558,15 @@ void QuickAccessUtility::_TearDownSignals()
 void QuickAccessUtility::FrontendCallback(enum obs_frontend_event event,
 					  void *data)
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::FrontendCallback");
 	UNUSED_PARAMETER(data);
 	if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
 		qau->_sceneCollectionChanging = false;
 		//qau->_SetupDocks();
 		qau->_SetupSignals();
 		qau->SceneChanged();
+		QTimer::singleShot(0, QCoreApplication::instance(),
+				   []() { QuickAccessSearchModal::Prewarm(); });
 	} else if (event == OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP) {
 		qau->_TearDownSignals();
 		qau->_sceneCollectionChanging = true;
@@ -368,6 +589,7 @@ void QuickAccessUtility::FrontendCallback(enum obs_frontend_event event,
 			QCoreApplication::instance()->thread(), []() {
 				std::unique_lock lock(qau->_m);
 				qau->RemoveDocks();
+				qau->InvalidateSceneClosures();
 				qau->_allSources.clear();
 				if (QuickAccessUtilityDialog::dialog) {
 					delete QuickAccessUtilityDialog::dialog;
@@ -377,32 +599,49 @@ void QuickAccessUtility::FrontendCallback(enum obs_frontend_event event,
 		if (!qau->_sceneCollectionChanging) {
 			qau->SceneChanged();
 		}
+	} else if (event == OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED) {
+		if (!qau->_sceneCollectionChanging) {
+			qau->_SchedulePrewarm();
+		}
 	}
 }
 
 void QuickAccessUtility::InitializeSearch()
 {
-	QuickAccessSearchModal::dialog->InitializeSearch();
+	if (QuickAccessSearchModal::dialog) {
+		QuickAccessSearchModal::dialog->InitializeSearch();
+	} else {
+		QTimer::singleShot(0, QCoreApplication::instance(), []() {
+			QuickAccessSearchModal::Prewarm();
+		});
+	}
 }
 
 void QuickAccessUtility::SceneChanged()
 {
+	QAU_TRACE_SCOPE("QuickAccessUtility::SceneChanged");
 	obs_source_t *newScene = obs_frontend_get_current_scene();
 
 	std::string uuid = obs_source_get_uuid(newScene);
 	QuickAccessSource *qaNewScene = _allSources[uuid].get();
 	if (qaNewScene) {
+		if (!_lastSceneId.empty() && _lastSceneId != uuid) {
+			_sceneHistory[_lastSceneId][uuid]++;
+		}
+		_lastSceneId = uuid;
 		_currentScene = qaNewScene;
 		_SetCurrentSceneSources();
 		for (auto &dock : _docks) {
 			dock->SetCurrentScene(qaNewScene);
 		}
+		_SchedulePrewarm();
 	}
 	obs_source_release(newScene);
 }
 
-void QuickAccessUtility::UpdateSceneSources()
+void QuickAccessUtility::UpdateSceneSources(QuickAccessSource *scene)
 {
+	InvalidateSceneClosures(scene);
 	_SetCurrentSceneSources();
 	for (auto &dock : _docks) {
 		dock->SetCurrentScene(_currentScene);
@@ -549,6 +788,7 @@ bool QuickAccessUtility::LinkSceneItem(obs_scene_t *scene,
 	QuickAccessSource *qasScene = self._allSources[sceneId].get();
 	self._allSources[sourceId].get()->addParent(qasScene);
 	self._allSources[sceneId].get()->addChild(qasSource);
+	qasSource->addSceneItem(qasScene, sceneItem);
 	return true;
 }
 
@@ -746,6 +986,21 @@ void OpenQAUDialog()
 	}
 }
 
+#ifdef QAU_TRACING
+void SaveTrace()
+{
+	char *dir = obs_module_config_path("");
+	os_mkdirs(dir);
+	bfree(dir);
+	auto name = QString("trace-%1.json")
+			    .arg(QDateTime::currentDateTime().toString(
+				    "yyyyMMdd-hhmmss"));
+	char *path = obs_module_config_path(QT_TO_UTF8(name));
+	QuickAccessTraceWrite(path);
+	bfree(path);
+}
+#endif
+
 void QuickAccessSearchModal::OpenQuickSearch(void *data, obs_hotkey_id id,
 					     obs_hotkey_t *hotkey, bool pressed)
 {
@@ -755,6 +1010,7 @@ void QuickAccessSearchModal::OpenQuickSearch(void *data, obs_hotkey_id id,
 	if (!pressed) {
 		return;
 	}
+	_openStart = os_gettime_ns();
 	const auto main_window =
 		static_cast<QMainWindow *>(obs_frontend_get_main_window());
 	const QRect &hostRect = main_window->geometry();
@@ -997,6 +1253,44 @@ QuickAccessSearchModal::QuickAccessSearchModal(QWidget *parent)
 	qau->quickSearchOpen = true;
 }
 
+void QuickAccessSearchModal::Prewarm()
+{
+	if (dialog || !qau || !qau->loaded) {
+		return;
+	}
+	const auto mainWindow =
+		static_cast<QMainWindow *>(obs_frontend_get_main_window());
+	dialog = new QuickAccessSearchModal(mainWindow);
+	// This shouldn't need to be done, but for some reason the first
+	// time we pop open the search, it is a tiny window and then
+	// disappears.  Opening and closing it once here avoids that, kept
+	// off screen so it neither flashes nor takes focus.
+	dialog->setAttribute(Qt::WA_DontShowOnScreen, true);
+	dialog->open();
+	dialog->adjustSize();
+	dialog->hide();
+	dialog->setAttribute(Qt::WA_DontShowOnScreen, false);
+}
+
+void QuickAccessSearchModal::paintEvent(QPaintEvent *event)
+{
+	QDialog::paintEvent(event);
+	if (!_openStart) {
+		return;
+	}
+	// The search box and results list paint after the dialog in the
+	// same pass, so the time is taken once the whole pass is done.
+	QTimer::singleShot(0, this, []() {
+		if (!_openStart) {
+			return;
+		}
+		uint64_t elapsed = os_gettime_ns() - _openStart;
+		_openStart = 0;
+		blog(LOG_INFO, "Quick Search painted %.2f ms after hotkey",
+		     static_cast<double>(elapsed) / 1000000.0);
+	});
+}
+
 QuickAccessSearchModal::~QuickAccessSearchModal()
 {
 	if (qau) {
@@ -1040,6 +1334,12 @@ extern "C" EXPORT void InitializeQAU(obs_module_t *module,
 		"Quick Access Utility");
 	action->connect(action, &QAction::triggered, OpenQAUDialog);
 
+#ifdef QAU_TRACING
+	QAction *traceAction = (QAction *)obs_frontend_add_tools_menu_qaction(
+		"Quick Access Utility: Save Trace");
+	traceAction->connect(traceAction, &QAction::triggered, SaveTrace);
+#endif
+
 	//QAction* action2 = (QAction*)obs_frontend_add_tools_menu_qaction(
 	//	"Quick Search"
 	//);
@@ -14,14 +14,21 @@
 #include <QToolBar>
 #include <QAction>
 #include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
 #include <vector>
+#include <list>
 #include <map>
+#include <unordered_set>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <atomic>
 
 class QuickAccessDock;
 class QuickAccessSource;
+struct QuickAccessSearchResult;
 
 class QuickAccessUtility;
 extern QuickAccessUtility *qad;
@@ -38,6 +45,23 @@ struct CreateDockFormData {
 	bool clickableScenes;
 };
 
+// Collects repaint requests from every dock and flushes them together, at
+// most once per display frame.
+class QuickAccessRepaintScheduler : public QObject {
+	Q_OBJECT
+public:
+	explicit QuickAccessRepaintScheduler(QObject *parent = nullptr);
+	void Schedule(QWidget *widget);
+
+private:
+	void _Flush();
+	int _FrameInterval() const;
+
+	QTimer _timer;
+	QElapsedTimer _sinceFlush;
+	std::vector<QPointer<QWidget>> _pending;
+};
+
 class QuickAccessUtility {
 public:
 	QuickAccessUtility(obs_module_t *m);
@@ -50,7 +74,14 @@ public:
 	void SceneChanged();
 	void UnloadDocks();
 	void InitializeSearch();
-	void UpdateSceneSources();
+	void UpdateSceneSources(QuickAccessSource *scene);
+	// Drops the cached closures that include scene, or all of them.
+	void InvalidateSceneClosures(QuickAccessSource *scene = nullptr);
+	void ScheduleRepaint(QWidget *widget);
+	std::shared_ptr<const QuickAccessSearchResult>
+	Search(const std::string &searchTerm);
+	inline uint64_t SearchGeneration() const { return _searchGeneration; }
+	inline void InvalidateSearch() { _searchGeneration++; }
 	inline std::vector<QuickAccessDock *> GetDocks() { return _docks; }
 	inline bool SourceCloneInstalled() { return _sourceCloneInstalled; }
 	inline bool dskInstalled() { return _dskInstalled; }
@@ -92,7 +123,13 @@ private:
 	void _SetupSignals();
 	void _TearDownSignals();
 	void _SetCurrentSceneSources();
-	void _AddChildren(QuickAccessSource *scene);
+	std::vector<QuickAccessSource *>
+	_GetSceneClosure(QuickAccessSource *scene);
+	void _AddChildren(QuickAccessSource *scene,
+			  std::vector<QuickAccessSource *> &closure,
+			  std::unordered_set<QuickAccessSource *> &seen);
+	void _SchedulePrewarm();
+	void _PrewarmSceneClosures();
 	void _SetupDocks();
 
 	obs_module_t *_module = nullptr;
@@ -100,11 +137,28 @@ private:
 	std::map<std::string, std::unique_ptr<QuickAccessSource>> _allSources;
 	QuickAccessSource *_currentScene = nullptr;
 	std::vector<QuickAccessSource *> _currentSceneSources;
+	// Sorted scene closures keyed by scene UUID, most recently used
+	// first.
+	std::list<std::pair<std::string, std::vector<QuickAccessSource *>>>
+		_sceneClosures;
+	// How often each scene was switched to from a given scene.
+	std::map<std::string, std::map<std::string, int>> _sceneHistory;
+	std::string _lastSceneId;
+	bool _prewarmPending = false;
+	std::mutex _closureMutex;
+	// Recent query results, most recently used first.  Dropped as a
+	// whole once _searchGeneration moves past them.
+	std::list<std::pair<std::string,
+			    std::shared_ptr<const QuickAccessSearchResult>>>
+		_searchResults;
+	std::atomic<uint64_t> _searchGeneration{1};
+	std::mutex _searchMutex;
 	bool _firstRun;
 	bool _sceneCollectionChanging = true;
 	bool _sourceCloneInstalled = false;
 	bool _dskInstalled = false;
 	obs_data_array_t *_dockSettings;
+	QuickAccessRepaintScheduler *_repaintScheduler = nullptr;
 
 	obs_hotkey_id _quick_search_hotkey_id;
 
@@ -150,12 +204,19 @@ public:
 	static void OpenQuickSearch(void *data, obs_hotkey_id id,
 				    obs_hotkey_t *hotkey, bool pressed);
 	static QuickAccessSearchModal *dialog;
+	static void Prewarm();
 	void SearchFocus();
 	void InitializeSearch();
 	void SourceCreated(QuickAccessSource *source);
 	void SourceDestroyed(QuickAccessSource *source);
 
+protected:
+	void paintEvent(QPaintEvent *event) override;
+
 private:
+	// Time of the last hotkey press, cleared once the first paint after
+	// it is done.
+	static uint64_t _openStart;
 	QLayout *_layout = nullptr;
 	QuickAccessDock *_widget = nullptr;
 };
@@ -5,6 +5,7 @@
 #include "quick-access.hpp"
 #include "quick-access-dock.hpp"
 #include "quick-access-utility.hpp"
+#include "quick-access-trace.hpp"
 
 #include <QToolBar>
 #include <QToolButton>
@@ -17,20 +18,23 @@
 #include <QApplication>
 #include <QThread>
 #include <QMetaObject>
-#include <QScrollArea>
 #include <QDialog>
 #include <QMouseEvent>
 #include <QInputDialog>
 #include <QMainWindow>
 #include <QString>
-#include <QScrollArea>
 #include <QTextStream>
 #include <QStyleOption>
 #include <QPainter>
 #include <QMenu>
 #include <QCursor>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QScrollBar>
+#include <QPointer>
 
 #include <algorithm>
+#include <unordered_set>
 #include "version.h"
 
 #define QT_UTF8(str) QString::fromUtf8(str)
@@ -40,14 +44,22 @@
 #define IMAGE_SOURCE_ID "image_source"
 #define MEDIA_SOURCE_ID "ffmpeg_source"
 
+#define PARENT_SCENES_ROW_HEIGHT 30
+#define PARENT_SCENES_MAX_ROWS 12
+#define QUICK_SEARCH_MAX_RESULTS 50
+#define SEARCH_FIRST_CHUNK_ROWS 100
+// The first pass stops once it has this many list rows, or runs out of time.
+#define SEARCH_FIRST_SCREEN_ROWS 40
+#define SEARCH_FIRST_SLICE_NS 8000000
+// Each later pass is sized to take about this long on the UI thread.
+#define SEARCH_SLICE_NS 2000000
+#define SEARCH_MIN_CHUNK_ROWS 50
+#define SEARCH_MAX_CHUNK_ROWS 20000
+
 extern QuickAccessUtility *qau;
 
-QuickAccessSourceList::QuickAccessSourceList(QWidget *parent,
-					     SearchType searchType)
-	: QListView(parent),
-	  _searchType(searchType),
-	  _activeSearch(false),
-	  _numActive(0)
+QuickAccessSourceList::QuickAccessSourceList(QWidget *parent)
+	: QListView(parent)
 {
 	_qaParent = dynamic_cast<QuickAccess *>(parent);
 	setContextMenuPolicy(Qt::CustomContextMenu);
@@ -110,29 +122,16 @@ QList<QString> QuickAccessSourceList::_getProjectorMenuMonitorsFormatted()
 	return projectorsFormatted;
 }
 
-void QuickAccessSourceList::_displayContextMenu()
+void QuickAccessSourceList::_buildContextMenu()
 {
-	// Get the QStackedWidget that contains this list.  For some reason
-	// in OBS 31.1, the QScrollArea within the QStackedWidget breaks
-	// the UI chain, and so the background color isn't inherited, and
-	// the context menu is transparent.
-	// TODO: Fix this grossness.
-	const auto parent = parentWidget()->parentWidget()->parentWidget()->parentWidget();
-	QMenu context(parent);
-	auto idx = currentIndex();
-
-	auto sourceModel = dynamic_cast<QuickAccessSourceModel *>(model());
-	if (!sourceModel) {
-		return;
-	}
-
-	auto source = sourceModel->item(idx.row());
-	if (!source) {
-		return;
-	}
-
-	auto addCurrent = new QAction("Add to Current Scene", this);
-	connect(addCurrent, &QAction::triggered, this, [this, source]() {
+	// Parent the menu to the QStackedWidget that contains this list so
+	// the background color is inherited and the menu isn't transparent.
+	_contextMenu = new QMenu(parentWidget());
+
+	_actionCtxtAddCurrent =
+		new QAction("Add to Current Scene", _contextMenu);
+	connect(_actionCtxtAddCurrent, &QAction::triggered, this, [this]() {
+		auto source = _contextSource;
 		obs_source_t *src = source->get();
 
 		bool studio = obs_frontend_preview_program_mode_active();
@@ -146,72 +145,66 @@ void QuickAccessSourceList::_displayContextMenu()
 		obs_source_release(currentScene);
 		_qaParent->DismissModal();
 	});
-	context.addAction(addCurrent);
-
-	if (qau->SourceCloneInstalled()) {
-		auto addCurrentClone =
-			new QAction("Add Clone to Current Scene", this);
-		connect(addCurrentClone, &QAction::triggered, this, [this, source]() {
-			bool studio =
-				obs_frontend_preview_program_mode_active();
-			obs_source_t *sceneSrc =
-				studio ? obs_frontend_get_current_preview_scene()
-				       : obs_frontend_get_current_scene();
-
-			const char *sourceCloneId = "source-clone";
-			const char *vId =
-				obs_get_latest_input_type_id(sourceCloneId);
-
-			std::string sourceName = source->getName();
-			std::string newSourceName = sourceName + " CLONE";
-
-			// Pop open QDialog to ask for new cloned source name.
-			bool ok;
-			QString text = QInputDialog::getText(
-				this, "Name of new source",
-				"Clone Name:", QLineEdit::Normal,
-				newSourceName.c_str(), &ok);
-			if (ok && !text.isEmpty()) {
-				newSourceName = text.toStdString();
-			} else {
-				return;
-			}
+	_contextMenu->addAction(_actionCtxtAddCurrent);
+
+	_actionCtxtAddCurrentClone =
+		new QAction("Add Clone to Current Scene", _contextMenu);
+	connect(_actionCtxtAddCurrentClone, &QAction::triggered, this, [this]() {
+		auto source = _contextSource;
+		bool studio = obs_frontend_preview_program_mode_active();
+		obs_source_t *sceneSrc =
+			studio ? obs_frontend_get_current_preview_scene()
+			       : obs_frontend_get_current_scene();
 
-			obs_source_t *newSource = obs_source_create(
-				vId, newSourceName.c_str(), NULL, NULL);
-			obs_data_t *settings =
-				obs_source_get_settings(newSource);
-			obs_data_set_string(settings, "clone",
-					    sourceName.c_str());
-			obs_source_update(newSource, settings);
-			obs_data_release(settings);
+		const char *sourceCloneId = "source-clone";
+		const char *vId = obs_get_latest_input_type_id(sourceCloneId);
 
-			obs_scene_t *scene = obs_scene_from_source(sceneSrc);
-			obs_scene_add(scene, newSource);
+		std::string sourceName = source->getName();
+		std::string newSourceName = sourceName + " CLONE";
 
+		// Pop open QDialog to ask for new cloned source name.
+		bool ok;
+		QString text = QInputDialog::getText(
+			this, "Name of new source", "Clone Name:",
+			QLineEdit::Normal, newSourceName.c_str(), &ok);
+		if (ok && !text.isEmpty()) {
+			newSourceName = text.toStdString();
+		} else {
 			obs_source_release(sceneSrc);
-			obs_source_release(newSource);
-			_qaParent->DismissModal();
-		});
-		context.addAction(addCurrentClone);
-	}
+			return;
+		}
 
-	context.addSeparator();
+		obs_source_t *newSource = obs_source_create(
+			vId, newSourceName.c_str(), NULL, NULL);
+		obs_data_t *settings = obs_source_get_settings(newSource);
+		obs_data_set_string(settings, "clone", sourceName.c_str());
+		obs_source_update(newSource, settings);
+		obs_data_release(settings);
 
-	if (source->hasProperties()) {
-		auto properties = new QAction("Properties", this);
-		connect(properties, &QAction::triggered, this,
-			[this, source]() { source->openProperties(); });
-		context.addAction(properties);
-	}
+		obs_scene_t *scene = obs_scene_from_source(sceneSrc);
+		obs_scene_add(scene, newSource);
+
+		obs_source_release(sceneSrc);
+		obs_source_release(newSource);
+		_qaParent->DismissModal();
+	});
+	_contextMenu->addAction(_actionCtxtAddCurrentClone);
+
+	_contextMenu->addSeparator();
+
+	_actionCtxtProperties = new QAction("Properties", _contextMenu);
+	connect(_actionCtxtProperties, &QAction::triggered, this,
+		[this]() { _contextSource->openProperties(); });
+	_contextMenu->addAction(_actionCtxtProperties);
 
-	auto filters = new QAction("Filters", this);
-	connect(filters, &QAction::triggered, this,
-		[this, source]() { source->openFilters(); });
-	context.addAction(filters);
+	_actionCtxtFilters = new QAction("Filters", _contextMenu);
+	connect(_actionCtxtFilters, &QAction::triggered, this,
+		[this]() { _contextSource->openFilters(); });
+	_contextMenu->addAction(_actionCtxtFilters);
 
-	auto rename = new QAction("Rename", this);
-	connect(rename, &QAction::triggered, this, [this, source]() {
+	_actionCtxtRenameSource = new QAction("Rename", _contextMenu);
+	connect(_actionCtxtRenameSource, &QAction::triggered, this, [this]() {
+		auto source = _contextSource;
 		std::string currentName = source->getName();
 
 		bool ok;
@@ -225,109 +218,150 @@ void QuickAccessSourceList::_displayContextMenu()
 			return;
 		}
 	});
-	context.addAction(rename);
-
-	if (source->hasInteract()) {
-		auto interact = new QAction("Interact", this);
-		connect(interact, &QAction::triggered, this,
-			[this, source]() { source->openInteract(); });
-		context.addAction(interact);
-	}
+	_contextMenu->addAction(_actionCtxtRenameSource);
+
+	_actionCtxtInteract = new QAction("Interact", _contextMenu);
+	connect(_actionCtxtInteract, &QAction::triggered, this,
+		[this]() { _contextSource->openInteract(); });
+	_contextMenu->addAction(_actionCtxtInteract);
+
+	_actionCtxtRefresh = new QAction("Refresh", _contextMenu);
+	connect(_actionCtxtRefresh, &QAction::triggered, this,
+		[this]() { _contextSource->refreshBrowser(); });
+	_contextMenu->addAction(_actionCtxtRefresh);
+
+	_actionCtxtToggleActivation = new QAction(_contextMenu);
+	connect(_actionCtxtToggleActivation, &QAction::triggered, this,
+		[this]() { _contextSource->toggleActivation(); });
+	_contextMenu->addAction(_actionCtxtToggleActivation);
+
+	_contextMenu->addSeparator();
+
+	_actionCtxtOpenWindowedProjector =
+		new QAction("Open Windowed Projector", _contextMenu);
+	connect(_actionCtxtOpenWindowedProjector, &QAction::triggered, this,
+		[this]() { _contextSource->openWindowedProjector(); });
+	_contextMenu->addAction(_actionCtxtOpenWindowedProjector);
+
+	_actionCtxtOpenFSProjector =
+		new QMenu("Full Screen Projector", _contextMenu);
+	_contextMenu->addMenu(_actionCtxtOpenFSProjector);
+	_updateProjectorMenu();
+
+	// The monitor list only changes when displays come and go.
+	auto screensChanged = [this]() { _monitorsDirty = true; };
+	connect(qApp, &QGuiApplication::screenAdded, this, screensChanged);
+	connect(qApp, &QGuiApplication::screenRemoved, this, screensChanged);
+}
 
-	if (source->hasRefresh()) {
-		auto refresh = new QAction("Refresh", this);
-		connect(refresh, &QAction::triggered, this,
-			[this, source]() { source->refreshBrowser(); });
-		context.addAction(refresh);
+void QuickAccessSourceList::_updateProjectorMenu()
+{
+	_monitorsDirty = false;
+	_actionCtxtOpenFSProjector->clear();
+	auto monitors = _getProjectorMenuMonitorsFormatted();
+	for (int i = 0; i < monitors.size(); i++) {
+		auto monitor =
+			new QAction(monitors[i], _actionCtxtOpenFSProjector);
+		_actionCtxtOpenFSProjector->addAction(monitor);
+		connect(monitor, &QAction::triggered, this, [this, i]() {
+			_contextSource->openFullScreenProjector(i);
+		});
 	}
+}
 
-	auto activateState = source ? source->activeState() : "";
-	if (activateState != "") {
-		auto activate = new QAction(activateState.c_str(), this);
-		connect(activate, &QAction::triggered, this,
-			[this, source]() { source->toggleActivation(); });
-		context.addAction(activate);
+void QuickAccessSourceList::_displayContextMenu()
+{
+	auto source = QuickAccessSourceModel::sourceAt(currentIndex());
+	if (!source) {
+		return;
 	}
-
-	context.addSeparator();
-
-	auto windowedProjector = new QAction("Open Windowed Projector", this);
-	connect(windowedProjector, &QAction::triggered, this,
-		[this, source]() { source->openWindowedProjector(); });
-	context.addAction(windowedProjector);
-
-	auto monitors = _getProjectorMenuMonitorsFormatted();
-	auto fsProjector = new QMenu("Full Screen Projector", &context);
-	for (int i = 0; i < monitors.size(); i++) {
-		auto monitor = new QAction(monitors[i], this);
-		fsProjector->addAction(monitor);
-		connect(monitor, &QAction::triggered, this,
-			[this, source, i]() {
-				source->openFullScreenProjector(i);
-			});
+	if (!_contextMenu) {
+		_buildContextMenu();
+	} else if (_monitorsDirty) {
+		_updateProjectorMenu();
 	}
-	context.addMenu(fsProjector);
 
-	context.exec(QCursor::pos());
+	// Only the source specific state is filled in per open.
+	_contextSource = source;
+	_actionCtxtAddCurrentClone->setVisible(qau->SourceCloneInstalled());
+	_actionCtxtProperties->setVisible(source->hasProperties());
+	_actionCtxtInteract->setVisible(source->hasInteract());
+	_actionCtxtRefresh->setVisible(source->hasRefresh());
+	auto activateState = source->activeState();
+	_actionCtxtToggleActivation->setText(activateState.c_str());
+	_actionCtxtToggleActivation->setVisible(activateState != "");
+
+	_contextMenu->exec(QCursor::pos());
+	_contextSource = nullptr;
 }
 
 QuickAccessSource *QuickAccessSourceList::currentSource()
 {
-	QModelIndex index = currentIndex();
-	auto m = dynamic_cast<QuickAccessSourceModel *>(model());
-	return m->item(index.row());
+	return QuickAccessSourceModel::sourceAt(currentIndex());
 }
 
 void QuickAccessSourceList::mousePressEvent(QMouseEvent *event)
 {
 	auto idx = indexAt(event->pos());
-	if (idx.isValid()) {
+	if (idx.isValid() && !QuickAccessGroupedModel::isHeader(idx)) {
 		setCurrentIndex(idx);
-		_qaParent->ClearSelections(this);
 	}
 	QListView::mousePressEvent(event);
+	if (idx.isValid()) {
+		update(idx);
+	}
+}
+
+void QuickAccessSourceList::mouseReleaseEvent(QMouseEvent *event)
+{
+	auto delegate =
+		dynamic_cast<QuickAccessSourceDelegate *>(itemDelegate());
+	QPersistentModelIndex pressed =
+		delegate ? delegate->pressedIndex() : QModelIndex();
+	QListView::mouseReleaseEvent(event);
+	if (pressed.isValid()) {
+		update(pressed);
+	}
 }
 
-QSize QuickAccessSourceList::sizeHint() const
+void QuickAccessSourceList::mouseMoveEvent(QMouseEvent *event)
 {
-	QMargins margins = contentsMargins();
-	int rows = _activeSearch ? _numActive : model()->rowCount();
-	if (rows == 0)
-		return QSize(width(), 0);
-	//int minHeight = minimumHeight();
-	int height =
-		rows * sizeHintForRow(0) + margins.top() + margins.bottom();
-	return QSize(width(), height);
+	_updateHover(event->pos());
+	QListView::mouseMoveEvent(event);
 }
 
-void QuickAccessSourceList::search(std::string searchTerm)
+void QuickAccessSourceList::leaveEvent(QEvent *event)
 {
-	auto m = dynamic_cast<QuickAccessSourceModel *>(model());
-	if (!m) {
+	_updateHover(QPoint(-1, -1));
+	QListView::leaveEvent(event);
+}
+
+void QuickAccessSourceList::_updateHover(const QPoint &pos)
+{
+	// Only the row that lost the hover and the row that gained it
+	// need to be repainted, everything else is unchanged.
+	auto delegate =
+		dynamic_cast<QuickAccessSourceDelegate *>(itemDelegate());
+	if (!delegate) {
 		return;
 	}
-	int rows = m->rowCount();
-	if (searchTerm == "") {
-		_activeSearch = false;
-		for (int i = 0; i < rows; i++) {
-			setRowHidden(i, false);
-		}
-		_numActive = rows;
-	} else {
-		_activeSearch = true;
-		_numActive = 0;
-		setUpdatesEnabled(false);
-		for (int i = 0; i < rows; i++) {
-			auto source = m->item(i);
-			bool match = source->hasMatch(searchTerm, _searchType);
-			if (match) {
-				_numActive++;
-			}
-			setRowHidden(i, !(match));
-		}
-		setUpdatesEnabled(true);
+	QModelIndex idx = indexAt(pos);
+	if (QuickAccessGroupedModel::isHeader(idx)) {
+		idx = QModelIndex();
+	}
+	SourceButton button =
+		idx.isValid() ? delegate->buttonAt(idx, visualRect(idx), pos)
+			      : SourceButton::None;
+	QPersistentModelIndex previous = delegate->hoverIndex();
+	if (!delegate->setHover(idx, button)) {
+		return;
+	}
+	if (previous.isValid()) {
+		update(previous);
+	}
+	if (idx.isValid() && previous != idx) {
+		update(idx);
 	}
-	updateGeometry();
 }
 
 DockMessage::DockMessage(QWidget *parent, std::string messageText,
@@ -373,7 +407,8 @@ QuickAccess::QuickAccess(QWidget *parent, QuickAccessDock *dock, QString name)
 	layout->setSpacing(0);
 	layout->setContentsMargins(0, 0, 0, 0);
 	_contents = nullptr;
-	_listsContainer = new QScrollArea(this);
+	_sourceList = new QuickAccessSourceList(this);
+	_setupSourceList();
 	_createListContainer();
 
 	std::string emptySearchText =
@@ -398,7 +433,7 @@ QuickAccess::QuickAccess(QWidget *parent, QuickAccessDock *dock, QString name)
 	auto sourceCount = _dock->SourceCount();
 
 	_contents = new QStackedWidget(this);
-	_contents->addWidget(_listsContainer);  //0
+	_contents->addWidget(_sourceList);      //0
 	_contents->addWidget(_emptySearch);     //1
 	_contents->addWidget(_emptyManual);     //2
 	_contents->addWidget(_emptyDynamic);    //3
@@ -422,30 +457,9 @@ QuickAccess::QuickAccess(QWidget *parent, QuickAccessDock *dock, QString name)
 		_searchText->setFocusPolicy(Qt::StrongFocus);
 		_searchText->connect(
 			_searchText, &QLineEdit::textChanged,
-			[this, dockType](const QString text) {
-				if (dockType == "Source Search") {
-					_noSearch = text.size() == 0;
-					int totalMatches = 0;
-					for (auto &qa : _qaLists) {
-						qa.listView->search(
-							text.toStdString());
-						int numMatches =
-							qa.listView
-								->visibleCount();
-						totalMatches += numMatches;
-						qa.listView->setHidden(
-							numMatches == 0);
-						qa.headerLabel->setHidden(
-							numMatches == 0);
-					}
-					if (_noSearch) {
-						_contents->setCurrentIndex(1);
-					} else if (totalMatches == 0) {
-						_contents->setCurrentIndex(4);
-					} else {
-						_contents->setCurrentIndex(0);
-					}
-				}
+			[this](const QString text) {
+				_noSearch = text.size() == 0;
+				_applySearch(text.toStdString());
 			});
 		layout->addWidget(_searchText);
 		layout->setSpacing(12);
@@ -538,150 +552,117 @@ QuickAccess::QuickAccess(QWidget *parent, QuickAccessDock *dock, QString name)
 
 QuickAccess::~QuickAccess()
 {
+	if (_addAvailableModel) {
+		// The open Add Sources dialog goes with this widget, its rows
+		// may outlive the registry entries they point at.
+		_addAvailableModel->resetSources({});
+		_addSelectedModel->resetSources({});
+	}
 	if (_current) {
 		obs_weak_source_release(_current);
 	}
-	_clearSceneItems();
 	source_signal_handler = nullptr;
 }
 
-void QuickAccess::_createListContainer()
+void QuickAccess::_setupSourceList()
 {
-	_qaLists.clear();
-	_sourceModels.clear();
-	for (auto &dg : _dock->DisplayGroups()) {
-		_sourceModels.emplace_back(
-			std::make_unique<QuickAccessSourceModel>());
-		auto model = _sourceModels[_sourceModels.size() - 1].get();
-		_qaLists.push_back(
-			{dg.name, nullptr,
-			 new QuickAccessSourceList(this, dg.searchType),
-			 model});
-		model->setSources(&dg.sources2);
-	}
-
-	auto widget = _listsContainer->widget();
-	if (widget) {
-		delete widget;
-	}
-	//_listsContainer->setStyleSheet("QWidget {background: transparent;}");
-	_listsContainer->viewport()->setAutoFillBackground(false);
-	_listsContainer->setContentsMargins(0, 0, 0, 0);
-	_listsContainer->setWidgetResizable(true);
-	_listsContainer->setStyleSheet("QScrollArea { border: none; background-color: palette(base); }");
-	//_listsContainer->setAttribute(Qt::WA_TranslucentBackground);
-	auto listsWidget = new QWidget(this);
-	listsWidget->setContentsMargins(0, 0, 0, 0);
-	auto lcLayout = new QVBoxLayout();
-	lcLayout->setContentsMargins(2, 2, 2, 2);
-	lcLayout->setSpacing(0);
-	int i = 0;
-	for (auto &qa : _qaLists) {
-		auto header = new QLabel(this);
-		header->setContentsMargins(0, 10, 0, 4);
-		header->setAlignment(Qt::AlignHCenter);
-		header->setText(qa.header.c_str());
-		header->setStyleSheet("QLabel { font-size: 18px }");
-		header->setSizePolicy(QSizePolicy::Preferred,
-				      QSizePolicy::Fixed);
-		header->setHidden(qa.header == "Manual");
-		qa.headerLabel = header;
-		lcLayout->addWidget(header);
-		qa.listView->setModel(qa.model);
-		qa.listView->setSizePolicy(QSizePolicy::Preferred,
-					   QSizePolicy::Fixed);
-		qa.listView->setStyleSheet("QListView {border: none; border-radius: palette(border_radius);}");
-		qa.listView->setContentsMargins(0, 0, 0, 10);
-		qa.listView->setMinimumHeight(0);
-		QuickAccessSourceDelegate *itemDelegate =
-			new QuickAccessSourceDelegate(qa.listView, _dock);
-		qa.listView->setItemDelegate(itemDelegate);
-		connect(itemDelegate,
-			&QuickAccessSourceDelegate::openPropertiesClicked, this,
-			[this](const QModelIndex &index) {
-				const QuickAccessSourceModel *model =
-					dynamic_cast<
-						const QuickAccessSourceModel *>(
-						index.model());
-				QuickAccessSource *source =
-					model->item(index.row());
-				source->openProperties();
-			});
-		connect(itemDelegate,
-			&QuickAccessSourceDelegate::openFiltersClicked, this,
-			[this, qa](const QModelIndex &index) {
-				const QuickAccessSourceModel *model =
-					dynamic_cast<
-						const QuickAccessSourceModel *>(
-						index.model());
-				QuickAccessSource *source =
-					model->item(index.row());
-				source->openFilters();
-			});
-		connect(itemDelegate,
-			&QuickAccessSourceDelegate::openParentScenesClicked,
-			this, [this, qa](const QModelIndex &index) {
-				const QuickAccessSourceModel *model =
-					dynamic_cast<
-						const QuickAccessSourceModel *>(
-						index.model());
-				QuickAccessSource *source =
-					model->item(index.row());
-				_currentSource = source;
-				_getSceneItems();
-				auto pos = QCursor::pos();
-				QScopedPointer<QMenu> popup(
-					_CreateParentSceneMenu());
-				if (popup) {
-					popup->exec(pos);
-				}
-			});
-		connect(itemDelegate, &QuickAccessSourceDelegate::itemSelected,
-			this, [this, i](const QModelIndex &index) {
-				if (_dock->GetType() != "Manual") {
-					return;
-				}
-				_activeIndex = i;
-				size_t numRows = index.model()->rowCount();
-				size_t currentRow = index.row();
-				_actionRemoveSource->setEnabled(true);
-				_actionSourceUp->setEnabled(currentRow > 0);
-				_actionSourceDown->setEnabled(currentRow <
-							      numRows - 1);
-
-				for (auto x : _actionsToolbar->actions()) {
-					auto wdgt =
-						_actionsToolbar->widgetForAction(
-							x);
-
-					if (!wdgt) {
-						continue;
-					}
-					wdgt->style()->unpolish(wdgt);
-					wdgt->style()->polish(wdgt);
+	// Every group is drawn by this one list, so rows are only painted
+	// when they scroll into view.
+	_sourceList->setStyleSheet("QListView {border: none; border-radius: palette(border_radius); background-color: palette(base);}");
+	_sourceList->setContentsMargins(0, 0, 0, 0);
+	_sourceList->setUniformItemSizes(true);
+	QuickAccessSourceDelegate *itemDelegate =
+		new QuickAccessSourceDelegate(_sourceList, _dock);
+	_sourceList->setItemDelegate(itemDelegate);
+	connect(itemDelegate, &QuickAccessSourceDelegate::openPropertiesClicked,
+		this, [this](const QModelIndex &index) {
+			QuickAccessSource *source =
+				QuickAccessSourceModel::sourceAt(index);
+			source->openProperties();
+		});
+	connect(itemDelegate, &QuickAccessSourceDelegate::openFiltersClicked,
+		this, [this](const QModelIndex &index) {
+			QuickAccessSource *source =
+				QuickAccessSourceModel::sourceAt(index);
+			source->openFilters();
+		});
+	connect(itemDelegate,
+		&QuickAccessSourceDelegate::openParentScenesClicked, this,
+		[this](const QModelIndex &index) {
+			QuickAccessSource *source =
+				QuickAccessSourceModel::sourceAt(index);
+			_currentSource = source;
+			auto pos = QCursor::pos();
+			QScopedPointer<QMenu> popup(_CreateParentSceneMenu());
+			if (popup) {
+				popup->exec(pos);
+			}
+		});
+	connect(itemDelegate, &QuickAccessSourceDelegate::itemSelected, this,
+		[this](const QModelIndex &index) {
+			if (_dock->GetType() != "Manual") {
+				return;
+			}
+			size_t numRows = index.model()->rowCount();
+			size_t currentRow = index.row();
+			_actionRemoveSource->setEnabled(true);
+			_actionSourceUp->setEnabled(currentRow > 0);
+			_actionSourceDown->setEnabled(currentRow < numRows - 1);
+
+			for (auto x : _actionsToolbar->actions()) {
+				auto wdgt = _actionsToolbar->widgetForAction(x);
+
+				if (!wdgt) {
+					continue;
 				}
-			});
-		connect(itemDelegate, &QuickAccessSourceDelegate::activateScene,
-			this, [this](const QModelIndex &index) {
-				const QuickAccessSourceModel *model =
-					dynamic_cast<
-						const QuickAccessSourceModel *>(
-						index.model());
-				QuickAccessSource *source =
-					model->item(index.row());
-				source->activateScene();
-			});
-		lcLayout->addWidget(qa.listView);
-		++i;
+				wdgt->style()->unpolish(wdgt);
+				wdgt->style()->polish(wdgt);
+			}
+		});
+	connect(itemDelegate, &QuickAccessSourceDelegate::activateScene, this,
+		[this](const QModelIndex &index) {
+			QuickAccessSource *source =
+				QuickAccessSourceModel::sourceAt(index);
+			source->activateScene();
+		});
+}
+
+void QuickAccess::_createListContainer()
+{
+	QAU_TRACE_SCOPE("QuickAccess::_createListContainer");
+	auto sourceModel = std::make_unique<QuickAccessSourceModel>();
+	sourceModel->setSources(_publishesSearch() ? &_published
+						   : &_dock->Sources());
+	sourceModel->setSorted(_dock->GetType() != "Manual");
+	auto groupedModel = std::make_unique<QuickAccessGroupedModel>();
+	std::vector<std::unique_ptr<QuickAccessSourceFilterModel>> filterModels;
+	if (_dock->IsModal()) {
+		// One ranked list, rebuilt by _updateRanked.
+		sourceModel->setSources(&_ranked);
+		sourceModel->setSorted(false);
+		groupedModel->addGroup("", sourceModel.get(), false);
+	} else {
+		// Every group is a filtered view onto the one shared source
+		// model, flattened with its header into the single list.
+		for (auto &dg : _dock->DisplayGroups()) {
+			filterModels.emplace_back(
+				std::make_unique<QuickAccessSourceFilterModel>(
+					nullptr, dg.searchType));
+			auto filter = filterModels.back().get();
+			filter->setSourceModel(sourceModel.get());
+			groupedModel->addGroup(dg.name, filter,
+					       dg.name != "Manual");
+		}
 	}
 
-	//QWidget *lSpacer = new QWidget(this);
-	//lSpacer->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Expanding);
-	//lcLayout->addWidget(lSpacer);
-	lcLayout->addStretch();
-	listsWidget->setLayout(lcLayout);
-	_listsContainer->setWidget(listsWidget);
-	listsWidget->setAutoFillBackground(false);
+	// The view doesn't delete the selection model it replaces.
+	auto selection = _sourceList->selectionModel();
+	_sourceList->setModel(groupedModel.get());
+	delete selection;
+
+	_groupedModel = std::move(groupedModel);
+	_filterModels = std::move(filterModels);
+	_sourceModel = std::move(sourceModel);
 }
 
 void QuickAccess::paintEvent(QPaintEvent *)
@@ -700,58 +681,9 @@ void QuickAccess::SearchFocus()
 	}
 }
 
-void QuickAccess::ClearSelections(QuickAccessSourceList *skip)
-{
-	for (auto &qa : _qaLists) {
-		if (qa.listView != skip) {
-			qa.listView->clearSelection();
-		}
-	}
-}
-
-void QuickAccess::_clearSceneItems()
-{
-	for (auto &sceneItem : _sceneItems) {
-		obs_sceneitem_release(sceneItem);
-	}
-	_sceneItems.clear();
-}
-
-void QuickAccess::_getSceneItems()
-{
-	_clearSceneItems();
-	obs_enum_scenes(QuickAccess::GetSceneItemsFromScene, this);
-}
-
-bool QuickAccess::GetSceneItemsFromScene(void *data, obs_source_t *s)
-{
-	obs_scene_t *scene = obs_scene_from_source(s);
-	obs_scene_enum_items(scene, QuickAccess::AddSceneItems, data);
-	return true;
-}
-
-bool QuickAccess::AddSceneItems(obs_scene_t *scene, obs_sceneitem_t *sceneItem,
-				void *data)
-{
-	UNUSED_PARAMETER(scene);
-
-	auto qa = static_cast<QuickAccess *>(data);
-	auto source = obs_sceneitem_get_source(sceneItem);
-	if (obs_source_is_group(source)) {
-		obs_scene_t *group = obs_group_from_source(source);
-		obs_scene_enum_items(group, QuickAccess::AddSceneItems, data);
-	}
-	if (qa->_currentSource->isSource(source)) {
-		obs_sceneitem_addref(sceneItem);
-		qa->_sceneItems.push_back(sceneItem);
-	}
-	return true;
-}
-
 QMenu *QuickAccess::_CreateParentSceneMenu()
 {
 	QMenu *popup = new QMenu("SceneMenu", this);
-	bool dark = obs_frontend_is_theme_dark();
 	auto title = new QWidgetAction(popup);
 	auto titleText = new QLabel("Parent Scenes", this);
 	titleText->setStyleSheet("QLabel { font-size: 12pt; margin: 10px; }");
@@ -759,96 +691,72 @@ QMenu *QuickAccess::_CreateParentSceneMenu()
 	title->setDefaultWidget(titleText);
 	popup->addAction(title);
 	popup->addSeparator();
-	if (_sceneItems.size() == 0) {
+
+	// The source keeps its scene items indexed, so this is only as
+	// large as the number of parents.
+	auto sceneItems = _currentSource ? _currentSource->sceneItems()
+					 : std::vector<obs_sceneitem_t *>();
+	if (sceneItems.size() == 0) {
 		auto noItems = new QWidgetAction(popup);
 		auto noItemsText = new QLabel("No Parent Scenes", this);
 		noItemsText->setStyleSheet("QLabel {margin: 30px;}");
 		noItemsText->setAlignment(Qt::AlignCenter);
 		noItems->setDefaultWidget(noItemsText);
 		popup->addAction(noItems);
+		return popup;
 	}
-	if (_sceneItems.size() > 1) {
+
+	int rows = std::min(static_cast<int>(sceneItems.size()),
+			    PARENT_SCENES_MAX_ROWS);
+	auto model = new QuickAccessSceneItemModel(sceneItems, popup);
+	auto filter = new QSortFilterProxyModel(popup);
+	filter->setSourceModel(model);
+	filter->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+	if (model->rowCount() > 1) {
 		auto wa = new QWidgetAction(popup);
 		auto t = new QLineEdit;
 		t->setPlaceholderText("Search...");
-		t->connect(
-			t, &QLineEdit::textChanged,
-			[popup](const QString text) {
-				foreach(auto action, popup->actions())
-					action->setVisible(
-						action->text().isEmpty() ||
-						action->text().contains(
-							text,
-							Qt::CaseInsensitive));
-			});
+		t->connect(t, &QLineEdit::textChanged, filter,
+			   [filter](const QString text) {
+				   filter->setFilterFixedString(text);
+			   });
 		wa->setDefaultWidget(t);
 		popup->addAction(wa);
 	}
-	popup->setStyleSheet("QMenu { menu-scrollable: 1; }");
-	auto getActionAfter = [](QMenu *menu, const QString &name) {
-		QList<QAction *> actions = menu->actions();
-
-		for (QAction *menuAction : actions) {
-			if (menuAction->text().compare(
-				    name, Qt::CaseInsensitive) >= 0)
-				return menuAction;
-		}
-
-		return (QAction *)nullptr;
-	};
-
-	auto addSource = [this, getActionAfter,
-			  dark](QMenu *pop, obs_sceneitem_t *sceneItem) {
-		auto scene = obs_sceneitem_get_scene(sceneItem);
-		obs_source_t *sceneSource = obs_scene_get_source(scene);
-		const char *name = obs_source_get_name(sceneSource);
-		QString qname = name;
-
-		QWidgetAction *popupItem = new QWidgetAction(this);
-		QWidget *itemWidget = new QuickAccessSceneItem(this, sceneItem);
-		if (dark) {
-			itemWidget->setStyleSheet(
-				"QuickAccessSceneItem:hover {background: #333333;}");
-		} else {
-			itemWidget->setStyleSheet(
-				"QuickAccessSceneItem:hover {background: #aaaaaa;}");
-		}
-
-		popupItem->setDefaultWidget(itemWidget);
-		popupItem->setParent(pop);
-
-		connect(popupItem, &QWidgetAction::triggered, this,
-			[this, name]() {
-				obs_source_t *sceneClicked =
-					obs_get_source_by_name(name);
-				if (obs_frontend_preview_program_mode_active()) {
-					obs_frontend_set_current_preview_scene(
-						sceneClicked);
-				} else {
-					obs_frontend_set_current_scene(
-						sceneClicked);
-				}
-
-				obs_source_release(sceneClicked);
-			});
 
-		QAction *after = getActionAfter(pop, qname);
-		pop->insertAction(after, popupItem);
-		return true;
-	};
-	for (auto &src : _sceneItems) {
-		addSource(popup, src);
-	}
+	auto list = new QListView;
+	list->setModel(filter);
+	list->setUniformItemSizes(true);
+	list->setMouseTracking(true);
+	list->viewport()->setAttribute(Qt::WA_Hover);
+	list->setSelectionMode(QAbstractItemView::NoSelection);
+	list->setFrameShape(QFrame::NoFrame);
+	list->setMinimumWidth(300);
+	list->setFixedHeight(rows * PARENT_SCENES_ROW_HEIGHT);
+	auto delegate = new QuickAccessSceneItemDelegate(list);
+	list->setItemDelegate(delegate);
+	connect(delegate, &QuickAccessSceneItemDelegate::sceneClicked, popup,
+		[popup](const QModelIndex &index) {
+			auto sceneItem =
+				QuickAccessSceneItemModel::sceneItemAt(index);
+			if (!sceneItem) {
+				return;
+			}
+			auto scene = obs_sceneitem_get_scene(sceneItem);
+			obs_source_t *sceneClicked = obs_scene_get_source(scene);
+			if (obs_frontend_preview_program_mode_active()) {
+				obs_frontend_set_current_preview_scene(
+					sceneClicked);
+			} else {
+				obs_frontend_set_current_scene(sceneClicked);
+			}
+			popup->close();
+		});
 
-	connect(popup, &QMenu::hovered, this, [popup](QAction *act) {
-		QList<QWidgetAction *> menuActions =
-			popup->findChildren<QWidgetAction *>();
-		for (auto menuAction : menuActions) {
-			auto widget = static_cast<QuickAccessSceneItem *>(
-				menuAction->defaultWidget());
-			widget->setHighlight(menuAction == act);
-		}
-	});
+	auto listAction = new QWidgetAction(popup);
+	listAction->setDefaultWidget(list);
+	popup->addAction(listAction);
 
 	return popup;
 }
@@ -858,12 +766,7 @@ void QuickAccess::Save(obs_data_t *saveObj)
 
 	if (_dock->GetType() == "Manual") {
 		auto itemsArr = obs_data_array_create();
-		auto &displayGroups = _dock->DisplayGroups();
-		if (displayGroups.size() == 0) {
-			return;
-		}
-		auto &dg = displayGroups[0];
-		for (auto &source : dg.sources2) {
+		for (auto &source : _dock->Sources()) {
 			auto itemObj = obs_data_create();
 			source->save(itemObj);
 			obs_data_array_push_back(itemsArr, itemObj);
@@ -874,11 +777,19 @@ void QuickAccess::Save(obs_data_t *saveObj)
 	}
 }
 
-void QuickAccess::Redraw()
+void QuickAccess::SourceChanged(QuickAccessSource *source)
 {
-	for (auto &qa : _qaLists) {
-		qa.listView->repaint();
+	if (_dock->IsModal()) {
+		_updateRanked();
+		return;
+	}
+	if (_publishesSearch() && !_publishedAll) {
+		// The new name may sort past the rows published so far.
+		_sourceModel->removeSource(source);
+		AddSource(source);
+		return;
 	}
+	_sourceModel->sourceChanged(source);
 }
 
 void QuickAccess::Load()
@@ -888,88 +799,214 @@ void QuickAccess::Load()
 		auto sourceCount = _dock->SourceCount();
 		int index = sourceCount > 0 ? 0 : 3;
 		_contents->setCurrentIndex(index);
+	} else if (_dock->GetType() == "Source Search") {
+		_createListContainer();
+		std::string searchTerm =
+			_searchText ? _searchText->text().toStdString() : "";
+		_applySearch(searchTerm);
 	}
 }
 
-void QuickAccess::UpdateVisibility()
+bool QuickAccess::_publishesSearch() const
 {
-	bool active = false;
-	for (auto &group : _dock->DisplayGroups()) {
-		group.headerItem->setHidden(!group.headerVisible);
-		if (group.headerVisible) {
-			active = true;
-		}
-		for (auto &source : group.sources) {
-			source.listItem->setHidden(!source.visible);
-		}
+	return _dock->GetType() == "Source Search" && !_dock->IsModal();
+}
+
+void QuickAccess::_applySearch(const std::string &searchTerm)
+{
+	QAU_TRACE_SCOPE("QuickAccess::_applySearch");
+	_publishToken++;
+	if (_publishesSearch()) {
+		// Rows are published again from the top for every term, so
+		// the filters only ever evaluate the rows being appended.
+		_sourceModel->resetSources({});
+		_publishing = searchTerm != "";
+		_publishedAll = false;
+		_publishChunk = SEARCH_FIRST_CHUNK_ROWS;
 	}
-	if (_noSearch) {
-		_contents->setCurrentIndex(1);
+	for (auto &filter : _filterModels) {
+		filter->setSearchTerm(searchTerm);
+	}
+	_updateRanked();
+	// Publish until there is a screenful of matches, the rest follows
+	// over the next event loop ticks.
+	QElapsedTimer timer;
+	timer.start();
+	while (_publishing &&
+	       _groupedModel->rowCount() < SEARCH_FIRST_SCREEN_ROWS &&
+	       timer.nsecsElapsed() < SEARCH_FIRST_SLICE_NS) {
+		_publishNext(SEARCH_FIRST_CHUNK_ROWS);
+	}
+	_updateSearchLists();
+	_publishMore();
+}
+
+void QuickAccess::_publishNext(int count)
+{
+	QAU_TRACE_SCOPE("QuickAccess::_publishNext");
+	auto &sources = _dock->Sources();
+	auto first = _published.empty()
+			     ? sources.begin()
+			     : std::upper_bound(sources.begin(), sources.end(),
+						_published.back(),
+						QuickAccessSource::sortLess);
+	auto last = first + std::min<ptrdiff_t>(count, sources.end() - first);
+	// Sources that sort the same go out together, the next chunk starts
+	// after the last one published.
+	while (last != first && last != sources.end() &&
+	       !QuickAccessSource::sortLess(*(last - 1), *last)) {
+		last++;
+	}
+	if (last == sources.end()) {
+		_publishing = false;
+		_publishedAll = true;
+	}
+	_sourceModel->addSources(std::vector<QuickAccessSource *>(first, last));
+}
+
+void QuickAccess::_publishMore()
+{
+	if (!_publishing) {
 		return;
 	}
-	_contents->setCurrentIndex(active ? 0 : 4);
+	auto token = _publishToken;
+	QTimer::singleShot(0, this, [this, token]() {
+		if (token != _publishToken) {
+			// A newer search took over.
+			return;
+		}
+		QAU_TRACE_SCOPE("QuickAccess::_publishMore");
+		// Rows are appended to every group, keep the ones in view
+		// from moving down as the groups above them grow.
+		QPersistentModelIndex anchor;
+		if (_sourceList->verticalScrollBar()->value() > 0) {
+			anchor = _sourceList->indexAt(QPoint(0, 0));
+		}
+		QElapsedTimer timer;
+		timer.start();
+		_publishNext(_publishChunk);
+		qint64 elapsed = std::max<qint64>(timer.nsecsElapsed(), 1);
+		if (anchor.isValid()) {
+			_sourceList->scrollTo(anchor,
+					      QAbstractItemView::PositionAtTop);
+		}
+		_updateSearchLists();
+		// Scale the next chunk to what fits in the time slice, so
+		// hotkeys and OBS' own UI get the event loop in between.
+		_publishChunk = static_cast<int>(std::clamp<qint64>(
+			_publishChunk * SEARCH_SLICE_NS / elapsed,
+			SEARCH_MIN_CHUNK_ROWS, SEARCH_MAX_CHUNK_ROWS));
+		_publishMore();
+	});
 }
 
-bool QuickAccess::AddSourceName(void *data, obs_source_t *source)
+void QuickAccess::RefreshSearch()
 {
-	auto qa = static_cast<QuickAccess *>(data);
-	std::string sourceName = obs_source_get_name(source);
-	qa->_allSourceNames.push_back(sourceName);
-	return true;
+	_updateRanked();
+	_updateSearchLists();
 }
 
-void QuickAccess::AddSource(QuickAccessSource *source, std::string groupName)
+void QuickAccess::_updateRanked()
 {
-	bool update = false;
-	auto it = std::find_if(
-		_qaLists.begin(), _qaLists.end(),
-		[groupName](QuickAccessSourceListView const &list) {
-			return list.header == groupName;
-		});
-	if (it != _qaLists.end()) {
-		// Add the new thing.
-		it->model->addSource(source);
-		it->listView->setVisible(true);
-		it->listView->updateGeometry();
-		update = true;
-	}
-	if (_dock->GetType() == "Manual" && update) {
+	QAU_TRACE_SCOPE("QuickAccess::_updateRanked");
+	if (!_dock->IsModal() || !_sourceModel) {
+		return;
+	}
+	std::string searchTerm =
+		_searchText ? _searchText->text().toStdString() : "";
+	std::vector<QuickAccessSource *> ranked;
+	if (searchTerm != "") {
+		auto result = qau->Search(searchTerm);
+		result->evaluate(qau->GetAllSources());
+		ranked = result->top(QUICK_SEARCH_MAX_RESULTS);
+	}
+	_sourceModel->resetSources(std::move(ranked));
+	if (_groupedModel->rowCount() > 0) {
+		_sourceList->setCurrentIndex(_groupedModel->index(0));
+	}
+}
+
+void QuickAccess::_updateSearchLists()
+{
+	if (_dock->GetType() != "Source Search") {
+		return;
+	}
+	// Empty groups contribute no rows, headers included.
+	int totalMatches = _groupedModel ? _groupedModel->rowCount() : 0;
+	if (_noSearch) {
+		_contents->setCurrentIndex(1);
+	} else if (totalMatches == 0 && _publishing) {
+		// Later chunks may still match.
+		_contents->setCurrentIndex(0);
+	} else if (totalMatches == 0) {
+		_contents->setCurrentIndex(4);
+	} else {
 		_contents->setCurrentIndex(0);
 	}
 }
 
-void QuickAccess::RemoveSource(QuickAccessSource *source, std::string groupName)
+void QuickAccess::AddSource(QuickAccessSource *source, int row)
 {
-	auto it = std::find_if(
-		_qaLists.begin(), _qaLists.end(),
-		[groupName](QuickAccessSourceListView const &list) {
-			return list.header == groupName;
-		});
-	if (it != _qaLists.end()) {
-		it->model->removeSource(source);
-		it->listView->updateGeometry();
+	if (!_sourceModel) {
+		return;
 	}
-	auto sourceCount = _dock->SourceCount();
-	if (_dock->GetType() == "Manual" && sourceCount == 0) {
-		_contents->setCurrentIndex(2);
+	if (_dock->IsModal()) {
+		// The new source may rank among the best matches.
+		_updateRanked();
+		_updateSearchLists();
+		return;
+	}
+	if (_publishesSearch() && !_publishedAll &&
+	    (_published.empty() ||
+	     QuickAccessSource::sortLess(_published.back(), source))) {
+		// Not published yet, a later chunk picks it up.
+		return;
+	}
+	// Filter views pick the new row up from the shared model.  Sorted
+	// models ignore row.
+	_sourceModel->addSource(source, row);
+	_updateSearchLists();
+	if (_dock->GetType() == "Manual" || _dock->GetType() == "Dynamic") {
+		_contents->setCurrentIndex(0);
 	}
 }
 
-void QuickAccess::SetItemsButtonVisibility()
+void QuickAccess::AddSources(const std::vector<QuickAccessSource *> &sources,
+			     int row)
 {
-	for (auto &qa : _qaLists) {
-		qa.listView->repaint();
+	if (!_sourceModel || sources.empty()) {
+		return;
+	}
+	if (_dock->IsModal()) {
+		_updateRanked();
+		_updateSearchLists();
+		return;
+	}
+	_sourceModel->addSources(sources, row);
+	_updateSearchLists();
+	if (_dock->GetType() == "Manual" || _dock->GetType() == "Dynamic") {
+		_contents->setCurrentIndex(0);
 	}
 }
 
-void QuickAccess::AddSourceMenuItem(obs_source_t *source)
+void QuickAccess::RemoveSource(QuickAccessSource *source)
 {
-	_menuSources.push_back(source);
+	if (!_sourceModel) {
+		return;
+	}
+	_sourceModel->removeSource(source);
+	_updateSearchLists();
+	auto sourceCount = _dock->SourceCount();
+	if (_dock->GetType() == "Manual" && sourceCount == 0) {
+		_contents->setCurrentIndex(2);
+	} else if (_dock->GetType() == "Dynamic" && sourceCount == 0) {
+		_contents->setCurrentIndex(3);
+	}
 }
 
-void QuickAccess::_ClearMenuSources()
+void QuickAccess::SetItemsButtonVisibility()
 {
-	_menuSources.clear();
+	qau->ScheduleRepaint(_sourceList->viewport());
 }
 
 void QuickAccess::DismissModal()
@@ -992,24 +1029,46 @@ QDialog *QuickAccess::CreateAddSourcePopupMenu()
 	QLineEdit *searchText = new QLineEdit();
 	searchText->setPlaceholderText("Search...");
 
-	// MenuSources *should* be empty, but just in case
-	_ClearMenuSources();
-	obs_enum_sources(AddSourceToWidget, this);
-	obs_enum_scenes(AddSourceToWidget, this);
-	QListWidget *allSourcesList = new QListWidget(this);
-
-	searchText->connect(
-		searchText, &QLineEdit::textChanged,
-		[allSourcesList](const QString text) {
-			for (int i = 0; i < allSourcesList->count(); i++) {
-				QListWidgetItem *item = allSourcesList->item(i);
-				QString wName = item->text();
-				item->setHidden(
-					text.isEmpty() ||
-					!wName.contains(text,
-							Qt::CaseInsensitive));
-			}
-		});
+	// Everything in the registry that isn't in the dock yet, sorted.
+	auto &dockSources = _dock->Sources();
+	std::unordered_set<QuickAccessSource *> inDock(dockSources.begin(),
+						       dockSources.end());
+	_addAvailable.clear();
+	_addSelected.clear();
+	for (auto &source : qau->GetAllSources()) {
+		if (inDock.find(source) == inDock.end()) {
+			_addAvailable.push_back(source);
+		}
+	}
+	std::sort(_addAvailable.begin(), _addAvailable.end(),
+		  QuickAccessSource::sortLess);
+
+	// Rows carry the registry entry itself, so nothing is looked up
+	// by name again on save.
+	auto availableModel = new QuickAccessSourceModel(popup);
+	availableModel->setSources(&_addAvailable);
+	availableModel->setSorted(true);
+	auto availableFilter =
+		new QuickAccessSourceFilterModel(popup, SearchType::Source);
+	availableFilter->setNameOnly(true);
+	availableFilter->setSourceModel(availableModel);
+	auto selectedModel = new QuickAccessSourceModel(popup);
+	selectedModel->setSources(&_addSelected);
+	_addAvailableModel = availableModel;
+	_addSelectedModel = selectedModel;
+
+	QListView *allSourcesList = new QListView(popup);
+	allSourcesList->setModel(availableFilter);
+	allSourcesList->setUniformItemSizes(true);
+
+	searchText->connect(searchText, &QLineEdit::textChanged,
+			    [availableFilter](const QString text) {
+				    // Every source shows until the first edit,
+				    // clearing the search then hides them all.
+				    availableFilter->setMatchEmpty(false);
+				    availableFilter->setSearchTerm(
+					    text.toStdString());
+			    });
 
 	allSourcesLayout->addWidget(allSourcesLabel);
 	allSourcesLayout->addWidget(searchText);
@@ -1030,7 +1089,9 @@ QDialog *QuickAccess::CreateAddSourcePopupMenu()
 	QLabel *dockSourcesLabel = new QLabel();
 	dockSourcesLabel->setText("Sources To Add");
 	QVBoxLayout *dockSourcesLayout = new QVBoxLayout();
-	QListWidget *dockSourcesList = new QListWidget();
+	QListView *dockSourcesList = new QListView(popup);
+	dockSourcesList->setModel(selectedModel);
+	dockSourcesList->setUniformItemSizes(true);
 	dockSourcesLayout->addWidget(dockSourcesLabel);
 	dockSourcesLayout->addWidget(dockSourcesList);
 	layoutH->addLayout(dockSourcesLayout);
@@ -1048,83 +1109,54 @@ QDialog *QuickAccess::CreateAddSourcePopupMenu()
 	layoutV->addLayout(buttonBar);
 	popup->setLayout(layoutV);
 
-	auto getItemInsert = [](QListWidget *list, const QString &name) {
-		for (int i = 0; i < list->count(); i++) {
-			auto item = list->item(i);
-			auto cmp =
-				item->text().compare(name, Qt::CaseInsensitive);
-			if (cmp > 0)
-				return i;
-			else if (cmp == 0)
-				return -1;
+	// Moving a row is a binary search into the sorted side and an
+	// append to the selected side.
+	auto addSelected = [availableModel, selectedModel, allSourcesList,
+			    addButton](const QModelIndex &index) {
+		auto source = QuickAccessSourceModel::sourceAt(index);
+		if (!source) {
+			return;
 		}
-
-		return list->count();
+		availableModel->removeSource(source);
+		selectedModel->addSource(source);
+		allSourcesList->setCurrentIndex(QModelIndex());
+		addButton->setDisabled(true);
 	};
 
-	auto addSource = [getItemInsert](QListWidget *list,
-					 obs_source_t *source) {
-		const char *name = obs_source_get_name(source);
-		const char *type = obs_source_get_unversioned_id(source);
-		QString qname = name;
-		QListWidgetItem *row = new QListWidgetItem(name);
-		QIcon icon;
-
-		if (strcmp(type, "scene") == 0)
-			icon = qau->GetSceneIcon();
-		else if (strcmp(type, "group") == 0)
-			icon = qau->GetGroupIcon();
-		else
-			icon = qau->GetIconFromType(type);
-
-		row->setIcon(icon);
-		auto insertIdx = getItemInsert(list, qname);
-
-		if (insertIdx >= 0)
-			list->insertItem(insertIdx, row);
-		return true;
-	};
-
-	_manualSourceNames.clear();
-	// TODO: Get list of current manual source names
-	for (auto &source : _dock->DisplayGroups()[0].sources2) {
-		_manualSourceNames.push_back(source->getName());
-	}
-
-	for (auto &src : _menuSources) {
-		if (std::find(_manualSourceNames.begin(),
-			      _manualSourceNames.end(),
-			      std::string(obs_source_get_name(src))) ==
-		    _manualSourceNames.end()) {
-			addSource(allSourcesList, src);
+	auto removeSelected = [availableModel, selectedModel, dockSourcesList,
+			       removeButton](const QModelIndex &index) {
+		auto source = QuickAccessSourceModel::sourceAt(index);
+		if (!source) {
+			return;
 		}
-	}
-	_ClearMenuSources();
+		selectedModel->removeSource(source);
+		availableModel->addSource(source);
+		dockSourcesList->setCurrentIndex(QModelIndex());
+		removeButton->setDisabled(true);
+	};
 
 	/*
 	 *  Handle selection changes in lists.
 	 */
-	connect(allSourcesList, &QListWidget::itemSelectionChanged, popup,
-		[allSourcesList, addButton, removeButton, dockSourcesList]() {
-			auto selectedItem = allSourcesList->currentItem();
-			if (selectedItem) {
-				addButton->setDisabled(false);
+	connect(allSourcesList->selectionModel(),
+		&QItemSelectionModel::currentChanged, popup,
+		[addButton, removeButton,
+		 dockSourcesList](const QModelIndex &current) {
+			addButton->setDisabled(!current.isValid());
+			if (current.isValid()) {
 				removeButton->setDisabled(true);
-				dockSourcesList->clearSelection();
-			} else {
-				addButton->setDisabled(true);
+				dockSourcesList->setCurrentIndex(QModelIndex());
 			}
 		});
 
-	connect(dockSourcesList, &QListWidget::itemSelectionChanged, popup,
-		[allSourcesList, addButton, removeButton, dockSourcesList]() {
-			auto selectedItem = allSourcesList->currentItem();
-			if (selectedItem) {
+	connect(dockSourcesList->selectionModel(),
+		&QItemSelectionModel::currentChanged, popup,
+		[addButton, removeButton,
+		 allSourcesList](const QModelIndex &current) {
+			removeButton->setDisabled(!current.isValid());
+			if (current.isValid()) {
 				addButton->setDisabled(true);
-				removeButton->setDisabled(false);
-				allSourcesList->clearSelection();
-			} else {
-				removeButton->setDisabled(true);
+				allSourcesList->setCurrentIndex(QModelIndex());
 			}
 		});
 
@@ -1132,48 +1164,21 @@ QDialog *QuickAccess::CreateAddSourcePopupMenu()
 	 *  Handle Add/Remove button clicks.
 	 */
 	connect(addButton, &QPushButton::released, popup,
-		[addButton, allSourcesList, dockSourcesList]() {
-			auto selectedItem = allSourcesList->takeItem(
-				allSourcesList->currentRow());
-			dockSourcesList->addItem(selectedItem);
-			allSourcesList->clearSelection();
-			addButton->setDisabled(true);
+		[addSelected, allSourcesList]() {
+			addSelected(allSourcesList->currentIndex());
 		});
 
 	connect(removeButton, &QPushButton::released, popup,
-		[removeButton, allSourcesList, dockSourcesList,
-		 getItemInsert]() {
-			auto selectedItem = dockSourcesList->takeItem(
-				dockSourcesList->currentRow());
-			auto insertIdx = getItemInsert(allSourcesList,
-						       selectedItem->text());
-			allSourcesList->insertItem(insertIdx, selectedItem);
-			dockSourcesList->clearSelection();
-			removeButton->setDisabled(true);
+		[removeSelected, dockSourcesList]() {
+			removeSelected(dockSourcesList->currentIndex());
 		});
 
 	/*
 	 *  Handle Double-clicking of items in lists.
 	 */
-	connect(allSourcesList, &QListWidget::itemDoubleClicked, popup,
-		[dockSourcesList, allSourcesList,
-		 addButton](QListWidgetItem *item) {
-			allSourcesList->takeItem(allSourcesList->row(item));
-			dockSourcesList->addItem(item);
-			allSourcesList->clearSelection();
-			addButton->setDisabled(true);
-		});
-
-	connect(dockSourcesList, &QListWidget::itemDoubleClicked, popup,
-		[dockSourcesList, allSourcesList, removeButton,
-		 getItemInsert](QListWidgetItem *item) {
-			dockSourcesList->takeItem(dockSourcesList->row(item));
-			auto insertIdx =
-				getItemInsert(allSourcesList, item->text());
-			allSourcesList->insertItem(insertIdx, item);
-			dockSourcesList->clearSelection();
-			removeButton->setDisabled(true);
-		});
+	connect(allSourcesList, &QListView::doubleClicked, popup, addSelected);
+	connect(dockSourcesList, &QListView::doubleClicked, popup,
+		removeSelected);
 
 	/*
 	 *  Handle Cancel/Save button clicks.
@@ -1181,33 +1186,43 @@ QDialog *QuickAccess::CreateAddSourcePopupMenu()
 	connect(cancelButton, &QPushButton::released, popup,
 		[popup]() { popup->reject(); });
 
-	connect(saveButton, &QPushButton::released, popup,
-		[this, popup, dockSourcesList]() {
-			for (int i = 0; i < dockSourcesList->count(); i++) {
-				auto item = dockSourcesList->item(i);
-				auto sceneName = item->text();
-				std::string sceneNameStr =
-					sceneName.toStdString();
-				obs_source_t *source = obs_get_source_by_name(
-					sceneNameStr.c_str());
-				std::string uuid = obs_source_get_uuid(source);
-				auto qaSource = qau->GetSource(uuid);
-				obs_source_release(source);
-				_dock->AddSource(qaSource, i);
-			}
-			popup->accept();
-		});
+	connect(saveButton, &QPushButton::released, popup, [this, popup]() {
+		// One batched insert into the dock's model.
+		_dock->AddSources(_addSelected);
+		popup->accept();
+	});
 
 	return popup;
 }
 
 void QuickAccess::AddSourcePopupMenu()
 {
-	QScopedPointer<QDialog> popup(CreateAddSourcePopupMenu());
+	// Unloading the scene collection deletes the dock, and with it the
+	// dialog, while the dialog's event loop is still running.
+	QPointer<QuickAccess> self(this);
+	QPointer<QDialog> popup(CreateAddSourcePopupMenu());
 	if (popup) {
 		popup->setModal(true);
 		popup->exec();
 	}
+	if (!self) {
+		return;
+	}
+	// The dialog's models point at these.
+	delete popup;
+	_addAvailableModel = nullptr;
+	_addSelectedModel = nullptr;
+	_addAvailable.clear();
+	_addSelected.clear();
+}
+
+void QuickAccess::SourceDestroyed(QuickAccessSource *source)
+{
+	// The registry entry is freed right after this.
+	if (_addAvailableModel) {
+		_addAvailableModel->removeSource(source);
+		_addSelectedModel->removeSource(source);
+	}
 }
 
 void QuickAccess::on_actionAddSource_triggered()
@@ -1217,9 +1232,7 @@ void QuickAccess::on_actionAddSource_triggered()
 
 void QuickAccess::on_actionRemoveSource_triggered()
 {
-	auto &qa = _qaLists[_activeIndex];
-
-	auto source = qa.listView->currentSource();
+	auto source = _sourceList->currentSource();
 
 	if (!source)
 		return;
@@ -1249,18 +1262,22 @@ void QuickAccess::on_actionDockProperties_triggered()
 
 void QuickAccess::on_actionSourceUp_triggered()
 {
-	if (_qaLists.size() == 0) {
+	if (_filterModels.size() == 0) {
 		return;
 	}
-	QuickAccessSourceListView qa = _qaLists[0];
-	auto model = qa.model;
-	auto index = qa.listView->currentIndex();
+	auto filter = _filterModels[0].get();
+	auto index = filter->mapToSource(
+		_groupedModel->mapToGroup(_sourceList->currentIndex()));
 	auto newRow = index.row() - 1;
-	model->swapRows(index.row(), newRow);
-	auto newIdx = model->index(newRow);
-	qa.listView->setCurrentIndex(newIdx);
+	_sourceModel->moveRow(QModelIndex(), index.row(), QModelIndex(),
+			      newRow);
+	auto newIdx = _groupedModel->mapFromGroup(
+		0, filter->mapFromSource(_sourceModel->index(newRow)));
+	_sourceList->setCurrentIndex(newIdx);
+	_dock->MarkDirty();
 	_actionSourceUp->setEnabled(newIdx.row() != 0);
-	_actionSourceDown->setEnabled(newIdx.row() < model->rowCount() - 1);
+	_actionSourceDown->setEnabled(newIdx.row() <
+				      _groupedModel->rowCount() - 1);
 	for (auto x : _actionsToolbar->actions()) {
 		auto widget = _actionsToolbar->widgetForAction(x);
 
@@ -1274,18 +1291,22 @@ void QuickAccess::on_actionSourceUp_triggered()
 
 void QuickAccess::on_actionSourceDown_triggered()
 {
-	if (_qaLists.size() == 0) {
+	if (_filterModels.size() == 0) {
 		return;
 	}
-	QuickAccessSourceListView qa = _qaLists[0];
-	auto model = qa.model;
-	auto index = qa.listView->currentIndex();
+	auto filter = _filterModels[0].get();
+	auto index = filter->mapToSource(
+		_groupedModel->mapToGroup(_sourceList->currentIndex()));
 	auto newRow = index.row() + 1;
-	model->swapRows(index.row(), newRow);
-	auto newIdx = model->index(newRow);
-	qa.listView->setCurrentIndex(newIdx);
+	_sourceModel->moveRow(QModelIndex(), index.row(), QModelIndex(),
+			      newRow + 1);
+	auto newIdx = _groupedModel->mapFromGroup(
+		0, filter->mapFromSource(_sourceModel->index(newRow)));
+	_sourceList->setCurrentIndex(newIdx);
+	_dock->MarkDirty();
 	_actionSourceUp->setEnabled(newIdx.row() != 0);
-	_actionSourceDown->setEnabled(newIdx.row() < model->rowCount() - 1);
+	_actionSourceDown->setEnabled(newIdx.row() <
+				      _groupedModel->rowCount() - 1);
 	for (auto x : _actionsToolbar->actions()) {
 		auto widget = _actionsToolbar->widgetForAction(x);
 
@@ -1297,119 +1318,187 @@ void QuickAccess::on_actionSourceDown_triggered()
 	}
 }
 
-QuickAccessSceneItem::QuickAccessSceneItem(QWidget *parent,
-					   obs_sceneitem_t *sceneItem)
-	: QWidget(parent),
-	  _sceneItem(sceneItem)
+QuickAccessSceneItemModel::QuickAccessSceneItemModel(
+	std::vector<obs_sceneitem_t *> items, QObject *parent)
+	: QAbstractListModel(parent)
 {
-	obs_sceneitem_addref(_sceneItem);
-	bool sourceVisible = obs_sceneitem_visible(_sceneItem);
-	auto scene = obs_sceneitem_get_scene(sceneItem);
-	obs_source_t *sceneSource = obs_scene_get_source(scene);
-	const char *name = obs_source_get_name(sceneSource);
-	const char *type = obs_source_get_unversioned_id(sceneSource);
-	QString qname = name;
+	// Names and icons are resolved once, up front.
+	_items.reserve(items.size());
+	for (auto &item : items) {
+		auto scene = obs_sceneitem_get_scene(item);
+		obs_source_t *sceneSource = obs_scene_get_source(scene);
+		const char *type = obs_source_get_unversioned_id(sceneSource);
 
-	setAttribute(Qt::WA_TranslucentBackground);
-	setMouseTracking(true);
-	//setStyleSheet("background: none");
-
-	QIcon icon;
-
-	if (strcmp(type, "scene") == 0)
-		icon = qau->GetSceneIcon();
-	else if (strcmp(type, "group") == 0)
-		icon = qau->GetGroupIcon();
-	else
-		icon = qau->GetIconFromType(type);
-
-	QPixmap pixmap = icon.pixmap(QSize(16, 16));
-	_iconLabel = new QLabel(this);
-	_iconLabel->setPixmap(pixmap);
-	_iconLabel->setStyleSheet("background: none");
-
-	_layout = new QHBoxLayout();
-	//_layout->setContentsMargins(0, 0, 0, 0);
-	_label = new QLabel(this);
-	_label->setText(name);
-	_label->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-	_label->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-	_label->setAttribute(Qt::WA_TranslucentBackground);
+		QIcon icon;
+		if (strcmp(type, "scene") == 0)
+			icon = qau->GetSceneIcon();
+		else if (strcmp(type, "group") == 0)
+			icon = qau->GetGroupIcon();
+		else
+			icon = qau->GetIconFromType(type);
 
-	_actionsToolbar = new QToolBar(this);
-	_actionsToolbar->setObjectName(QStringLiteral("actionsToolbar"));
-	_actionsToolbar->setIconSize(QSize(16, 16));
-	_actionsToolbar->setFixedHeight(22);
-	_actionsToolbar->setFloatable(false);
-	_actionsToolbar->setSizePolicy(QSizePolicy::Maximum,
-				       QSizePolicy::Maximum);
-	_actionsToolbar->setStyleSheet(
-		"QToolBar{spacing: 0px;} QToolButton {margin-left: 0px; margin-right: 0px; background: none; border: none;}");
-
-	_vis = new QCheckBox();
-	_vis->setProperty("visibilityCheckBox", true);
-	_vis->setProperty("class", "indicator-visibility");
-	_vis->setSizePolicy(QSizePolicy::Maximum, QSizePolicy::Maximum);
-	_vis->setChecked(sourceVisible);
-	_vis->setStyleSheet("background: none");
-	_vis->setAccessibleName("Source Visibility");
-	_vis->setAccessibleDescription("Source Visibility");
-	_vis->setToolTip("Source Visibility");
-
-	auto actionTransform = new QAction(this);
-	actionTransform->setObjectName(QStringLiteral("actionTransform"));
-	actionTransform->setShortcutContext(Qt::WidgetWithChildrenShortcut);
-	actionTransform->setProperty("themeID", "cogsIcon");
-	actionTransform->setProperty("class", "icon-gear");
-	actionTransform->setText(QT_UTF8(obs_module_text("Transformation")));
-	connect(actionTransform, SIGNAL(triggered()), this,
-		SLOT(on_actionTransform_triggered()));
-	_actionsToolbar->addAction(actionTransform);
-	//_actionsToolbar->setStyleSheet("QToolButton {background: none; border: none;} ");
-
-	_layout->addWidget(_iconLabel);
-	_layout->setSpacing(4);
-	_layout->addWidget(_label);
-	_layout->addWidget(_vis);
-	_layout->addWidget(_actionsToolbar);
-	setLayout(_layout);
-	// Themes need the QAction dynamic properties
-	for (QAction *x : _actionsToolbar->actions()) {
-		QWidget *temp = _actionsToolbar->widgetForAction(x);
+		_items.push_back(
+			{item, QT_UTF8(obs_source_get_name(sceneSource)), icon});
+	}
+	auto &collator = QuickAccessSource::collator();
+	std::sort(_items.begin(), _items.end(),
+		  [&collator](const Entry &a, const Entry &b) {
+			  return collator.compare(a.name, b.name) < 0;
+		  });
+}
 
-		for (QByteArray &y : x->dynamicPropertyNames()) {
-			temp->setProperty(y, x->property(y));
-		}
+QuickAccessSceneItemModel::~QuickAccessSceneItemModel()
+{
+	for (auto &entry : _items) {
+		obs_sceneitem_release(entry.item);
 	}
+}
 
-	auto setItemVisible = [this](bool val) {
-		obs_sceneitem_set_visible(_sceneItem, val);
-	};
-	connect(_vis, &QAbstractButton::clicked, setItemVisible);
+obs_sceneitem_t *QuickAccessSceneItemModel::sceneItemAt(const QModelIndex &index)
+{
+	if (!index.isValid()) {
+		return nullptr;
+	}
+	return static_cast<obs_sceneitem_t *>(
+		index.data(Qt::UserRole).value<void *>());
 }
 
-QuickAccessSceneItem::~QuickAccessSceneItem()
+int QuickAccessSceneItemModel::rowCount(const QModelIndex &parent) const
 {
-	obs_sceneitem_release(_sceneItem);
+	return parent.isValid() ? 0 : static_cast<int>(_items.size());
 }
 
-void QuickAccessSceneItem::on_actionTransform_triggered()
+QVariant QuickAccessSceneItemModel::data(const QModelIndex &index,
+					 int role) const
 {
-	obs_frontend_open_sceneitem_edit_transform(_sceneItem);
+	if (index.row() < 0 || index.row() >= rowCount()) {
+		return {};
+	}
+	auto &entry = _items[index.row()];
+	switch (role) {
+	case Qt::DisplayRole:
+		return entry.name;
+	case Qt::DecorationRole:
+		return entry.icon;
+	case Qt::CheckStateRole:
+		return obs_sceneitem_visible(entry.item) ? Qt::Checked
+							 : Qt::Unchecked;
+	case Qt::UserRole:
+		return QVariant::fromValue(static_cast<void *>(entry.item));
+	default:
+		return {};
+	}
 }
 
-void QuickAccessSceneItem::setHighlight(bool h)
+bool QuickAccessSceneItemModel::setData(const QModelIndex &index,
+					const QVariant &value, int role)
 {
-	setBackgroundRole(h ? QPalette::Highlight : QPalette::Window);
-	setAutoFillBackground(h);
+	if (role != Qt::CheckStateRole || index.row() < 0 ||
+	    index.row() >= rowCount()) {
+		return false;
+	}
+	obs_sceneitem_set_visible(_items[index.row()].item,
+				  value.toInt() == Qt::Checked);
+	emit dataChanged(index, index, {Qt::CheckStateRole});
+	return true;
 }
 
-void QuickAccessSceneItem::paintEvent(QPaintEvent *)
+Qt::ItemFlags QuickAccessSceneItemModel::flags(const QModelIndex &index) const
 {
-	QStyleOption opt;
-	opt.initFrom(this);
-	QPainter p(this);
-	style()->drawPrimitive(QStyle::PE_Widget, &opt, &p, this);
+	UNUSED_PARAMETER(index);
+	return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+}
+
+QuickAccessSceneItemDelegate::QuickAccessSceneItemDelegate(QObject *parent)
+	: QStyledItemDelegate(parent)
+{
+}
+
+QRect QuickAccessSceneItemDelegate::_visibilityRect(const QRect &rect)
+{
+	return QRect(rect.right() - 52, rect.y() + 7, 16, 16);
+}
+
+QRect QuickAccessSceneItemDelegate::_transformRect(const QRect &rect)
+{
+	return QRect(rect.right() - 30, rect.y(), 30, 30);
+}
+
+void QuickAccessSceneItemDelegate::paint(QPainter *painter,
+					 const QStyleOptionViewItem &option,
+					 const QModelIndex &index) const
+{
+	QRect rect = option.rect;
+	if (option.state & QStyle::State_MouseOver)
+		painter->fillRect(rect, option.palette.highlight());
+
+	auto icon = index.data(Qt::DecorationRole).value<QIcon>();
+	icon.paint(painter, QRect(rect.x() + 7, rect.y() + 7, 16, 16));
+
+	QRect textRect(rect.x() + 30, rect.y(), rect.width() - 90,
+		       rect.height());
+	QString name = option.fontMetrics.elidedText(
+		index.data(Qt::DisplayRole).toString(), Qt::ElideRight,
+		textRect.width());
+	painter->drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, name);
+
+	const QWidget *widget = option.widget;
+	QStyle *style = widget ? widget->style() : QApplication::style();
+
+	QStyleOptionButton visibility;
+	visibility.rect = _visibilityRect(rect);
+	visibility.state = QStyle::State_Enabled;
+	visibility.state |= index.data(Qt::CheckStateRole).toInt() ==
+					    Qt::Checked
+				    ? QStyle::State_On
+				    : QStyle::State_Off;
+	style->drawPrimitive(QStyle::PE_IndicatorCheckBox, &visibility,
+			     painter, widget);
+
+	std::string mode = obs_frontend_is_theme_dark() ? "theme:Dark/"
+							: "theme:Light/";
+	std::string transformIconPath = mode + "settings/general.svg";
+	QStyleOptionButton transform;
+	transform.rect = _transformRect(rect);
+	transform.icon = QIcon(transformIconPath.c_str());
+	transform.iconSize = QSize(16, 16);
+	transform.state = QStyle::State_Enabled | QStyle::State_Raised;
+	style->drawControl(QStyle::CE_PushButtonLabel, &transform, painter,
+			   widget);
+}
+
+QSize QuickAccessSceneItemDelegate::sizeHint(
+	const QStyleOptionViewItem & /*option*/,
+	const QModelIndex & /*index*/) const
+{
+	return QSize(300, PARENT_SCENES_ROW_HEIGHT);
+}
+
+bool QuickAccessSceneItemDelegate::editorEvent(
+	QEvent *event, QAbstractItemModel *model,
+	const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+	if (event->type() == QEvent::MouseButtonPress ||
+	    event->type() == QEvent::MouseButtonDblClick) {
+		return true;
+	}
+	if (event->type() != QEvent::MouseButtonRelease) {
+		return false;
+	}
+
+	QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+	if (_visibilityRect(option.rect).contains(mouseEvent->pos())) {
+		bool visible = index.data(Qt::CheckStateRole).toInt() ==
+			       Qt::Checked;
+		model->setData(index, visible ? Qt::Unchecked : Qt::Checked,
+			       Qt::CheckStateRole);
+	} else if (_transformRect(option.rect).contains(mouseEvent->pos())) {
+		obs_frontend_open_sceneitem_edit_transform(
+			QuickAccessSceneItemModel::sceneItemAt(index));
+	} else {
+		emit sceneClicked(index);
+	}
+	return true;
 }
 
 UpdateDockDialog::UpdateDockDialog(QuickAccessDock *dock, QWidget *parent)
@@ -1507,13 +1596,6 @@ void UpdateDockDialog::on_cancel()
 	done(DialogCode::Rejected);
 }
 
-bool AddSourceToWidget(void *data, obs_source_t *source)
-{
-	auto qa = static_cast<QuickAccess *>(data);
-	qa->AddSourceMenuItem(source);
-	return true;
-}
-
 void EnumerateFilters(obs_source_t *parentScene, obs_source_t *filter,
 		      void *param)
 {
@@ -3,6 +3,7 @@
 #include <map>
 #include <set>
 #include <memory>
+#include <climits>
 
 #include <obs-module.h>
 #include <obs-frontend-api.h>
@@ -26,13 +27,14 @@
 #include <QStyledItemDelegate>
 #include <QPainter>
 #include <QLineEdit>
-#include <QScrollArea>
 
 enum class SearchType;
 class QuickAccessSource;
 class QuickAccess;
 class QuickAccessDock;
 class QuickAccessSourceModel;
+class QuickAccessSourceFilterModel;
+class QuickAccessGroupedModel;
 
 class DockMessage : public QWidget {
 	Q_OBJECT
@@ -44,19 +46,20 @@ public:
 class QuickAccessSourceList : public QListView {
 	Q_OBJECT
 public:
-	QuickAccessSourceList(QWidget *parent, SearchType searchType);
-	QSize sizeHint() const override;
-	void search(std::string searchTerm);
-	inline int visibleCount() const { return _numActive; }
+	QuickAccessSourceList(QWidget *parent);
 	QuickAccessSource *currentSource();
 
 private:
 	QuickAccess *_qaParent;
 	void _displayContextMenu();
+	void _buildContextMenu();
+	void _updateProjectorMenu();
+	void _updateHover(const QPoint &pos);
 	QList<QString> _getProjectorMenuMonitorsFormatted();
-	SearchType _searchType;
-	bool _activeSearch;
-	int _numActive;
+	// Built on first use and reused, see _displayContextMenu.
+	QMenu *_contextMenu = nullptr;
+	QuickAccessSource *_contextSource = nullptr;
+	bool _monitorsDirty = true;
 	QAction *_actionCtxtAddCurrent;
 	QAction *_actionCtxtAddCurrentClone;
 	QAction *_actionCtxtProperties;
@@ -72,38 +75,60 @@ private:
 
 protected:
 	void mousePressEvent(QMouseEvent *event) override;
+	void mouseReleaseEvent(QMouseEvent *event) override;
+	void mouseMoveEvent(QMouseEvent *event) override;
+	void leaveEvent(QEvent *event) override;
 
 signals:
 	void selectedItemChanged(const QModelIndex &index);
 };
 
-struct QuickAccessSourceListView {
-	std::string header;
-	QLabel *headerLabel;
-	QuickAccessSourceList *listView;
-	QuickAccessSourceModel *model;
+// Scene items that show a source, for the Parent Scenes popup.
+class QuickAccessSceneItemModel : public QAbstractListModel {
+	Q_OBJECT
+
+public:
+	// Takes ownership of one reference to each item.
+	explicit QuickAccessSceneItemModel(std::vector<obs_sceneitem_t *> items,
+					   QObject *parent = nullptr);
+	~QuickAccessSceneItemModel();
+	static obs_sceneitem_t *sceneItemAt(const QModelIndex &index);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index,
+		      int role = Qt::DisplayRole) const override;
+	bool setData(const QModelIndex &index, const QVariant &value,
+		     int role = Qt::EditRole) override;
+	Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+	struct Entry {
+		obs_sceneitem_t *item;
+		QString name;
+		QIcon icon;
+	};
+	std::vector<Entry> _items;
 };
 
-class QuickAccessSceneItem : public QWidget {
+class QuickAccessSceneItemDelegate : public QStyledItemDelegate {
 	Q_OBJECT
 
 public:
-	QuickAccessSceneItem(QWidget *parent, obs_sceneitem_t *sceneItem);
-	~QuickAccessSceneItem();
-	void setHighlight(bool h);
-	//void mouseReleaseEvent(QMouseEvent *e) override;
-	void paintEvent(QPaintEvent *) override;
+	explicit QuickAccessSceneItemDelegate(QObject *parent = nullptr);
+	void paint(QPainter *painter, const QStyleOptionViewItem &option,
+		   const QModelIndex &index) const override;
+	QSize sizeHint(const QStyleOptionViewItem &option,
+		       const QModelIndex &index) const override;
+	bool editorEvent(QEvent *event, QAbstractItemModel *model,
+			 const QStyleOptionViewItem &option,
+			 const QModelIndex &index) override;
 
-private:
-	obs_sceneitem_t *_sceneItem = nullptr;
-	QLabel *_iconLabel = nullptr;
-	QHBoxLayout *_layout = nullptr;
-	QLabel *_label = nullptr;
-	QToolBar *_actionsToolbar;
-	QCheckBox *_vis = nullptr;
+signals:
+	void sceneClicked(const QModelIndex &index);
 
-private slots:
-	void on_actionTransform_triggered();
+private:
+	static QRect _visibilityRect(const QRect &rect);
+	static QRect _transformRect(const QRect &rect);
 };
 
 class QuickAccess : public QWidget {
@@ -112,33 +137,30 @@ class QuickAccess : public QWidget {
 public:
 	QuickAccess(QWidget *parent, QuickAccessDock *dock, QString name);
 	~QuickAccess();
-	void AddSource(QuickAccessSource *source, std::string groupName);
-	void RemoveSource(QuickAccessSource *source, std::string groupName);
+	void AddSource(QuickAccessSource *source, int row = -1);
+	void AddSources(const std::vector<QuickAccessSource *> &sources,
+			int row = -1);
+	void RemoveSource(QuickAccessSource *source);
 	void Load();
-	void UpdateVisibility();
 	void Save(obs_data_t *saveObj);
-	void AddSourceMenuItem(obs_source_t *source);
 	void SetItemsButtonVisibility();
-	void Redraw();
-	void ClearSelections(QuickAccessSourceList *skip);
+	void SourceChanged(QuickAccessSource *source);
+	void SourceDestroyed(QuickAccessSource *source);
+	void RefreshSearch();
 	void SearchFocus();
 	void DismissModal();
-	static bool AddSourceName(void *data, obs_source_t *source);
-	static bool GetSceneItemsFromScene(void *data, obs_source_t *s);
-	static bool AddSceneItems(obs_scene_t *s, obs_sceneitem_t *si,
-				  void *data);
 
 	virtual void paintEvent(QPaintEvent *);
 
 private:
 	QuickAccessDock *_dock;
 	QStackedWidget *_contents;
-	QScrollArea *_listsContainer;
+	QuickAccessSourceList *_sourceList = nullptr;
 	DockMessage *_emptySearch;
 	DockMessage *_emptyManual;
 	DockMessage *_emptyDynamic;
 	DockMessage *_noSearchResults;
-	QLineEdit *_searchText;
+	QLineEdit *_searchText = nullptr;
 	QToolBar *_actionsToolbar;
 	QAction *_actionAddSource = nullptr;
 	QAction *_actionRemoveSource = nullptr;
@@ -151,18 +173,35 @@ private:
 	signal_handler_t *source_signal_handler = nullptr;
 	void AddSourcePopupMenu();
 	QMenu *_CreateParentSceneMenu();
-	void _ClearMenuSources();
-	void _getSceneItems();
-	void _clearSceneItems();
+	void _setupSourceList();
 	void _createListContainer();
-	std::vector<obs_source_t *> _menuSources;
-	std::vector<std::string> _manualSourceNames;
-	std::vector<std::string> _allSourceNames;
+	void _updateSearchLists();
+	void _updateRanked();
+	bool _publishesSearch() const;
+	void _applySearch(const std::string &searchTerm);
+	void _publishNext(int count);
+	void _publishMore();
+	// Backing rows for the Add Sources dialog.
+	std::vector<QuickAccessSource *> _addAvailable;
+	std::vector<QuickAccessSource *> _addSelected;
+	// Set while the dialog is open.
+	QuickAccessSourceModel *_addAvailableModel = nullptr;
+	QuickAccessSourceModel *_addSelectedModel = nullptr;
 	std::set<std::string> _dynamicScenes;
-	std::vector<obs_sceneitem_t *> _sceneItems;
 
-	std::vector<QuickAccessSourceListView> _qaLists;
-	std::vector<std::unique_ptr<QuickAccessSourceModel>> _sourceModels;
+	std::unique_ptr<QuickAccessSourceModel> _sourceModel;
+	std::vector<std::unique_ptr<QuickAccessSourceFilterModel>> _filterModels;
+	std::unique_ptr<QuickAccessGroupedModel> _groupedModel;
+	// Quick Search shows one list of the best matches instead of the
+	// search groups.
+	std::vector<QuickAccessSource *> _ranked;
+	// Source Search docks hand their sorted sources to the filters a
+	// chunk at a time, this is the prefix published so far.
+	std::vector<QuickAccessSource *> _published;
+	bool _publishing = false;
+	bool _publishedAll = false;
+	int _publishChunk = 0;
+	uint64_t _publishToken = 0;
 
 	bool _active = true;
 	bool _switchingSC = false;
@@ -178,8 +217,6 @@ private:
 	QAction *_actionCtxtRenameSource = nullptr;
 	QAction *_actionCtxtInteract = nullptr;
 
-	int _activeIndex = -1;
-
 private slots:
 	void on_actionAddSource_triggered();
 	void on_actionRemoveSource_triggered();
@@ -215,6 +252,5 @@ private slots:
 	void on_cancel();
 };
 
-bool AddSourceToWidget(void *data, obs_source_t *source);
 void EnumerateFilters(obs_source_t *parentScene, obs_source_t *filter,
 		      void *param);